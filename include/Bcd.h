@@ -0,0 +1,46 @@
+/*
+Packed BCD counters for the numbers on screen.
+
+A counter keeps its decimal digits, two per byte, so counting up and
+showing the value never divides. Every digit that changed since the last
+draw has its bit in `dirty`, and bcdDraw() writes only those cells. The
+value is drawn left-aligned without leading zeros; when the number of
+digits changes every cell is dirty.
+*/
+
+#ifndef BCD_H
+#define BCD_H
+
+#include <stdint.h>
+
+// Enough for any uint16_t
+#define BCD_DIGITS 6
+
+struct BcdCounter
+{
+  uint8_t packed[BCD_DIGITS / 2]; // Least significant byte first, low nibble first
+  uint8_t length;                 // Digits shown, at least 1
+  uint8_t dirty;                  // Bit i: digit i (0 = ones) not drawn yet
+};
+
+// Zero, every digit dirty
+void bcdClear(BcdCounter &counter);
+// Load a binary value, e.g. one read from EEPROM
+void bcdSet(BcdCounter &counter, uint16_t value);
+void bcdIncrement(BcdCounter &counter);
+// Make `to` show what `from` shows, marking the digits that differ
+void bcdCopy(BcdCounter &to, const BcdCounter &from);
+// Negative, zero or positive as a is less than, equal to or above b
+int8_t bcdCompare(const BcdCounter &a, const BcdCounter &b);
+
+inline uint8_t bcdDigit(const BcdCounter &counter, uint8_t digit)
+{
+  uint8_t pair = counter.packed[digit >> 1];
+  return (digit & 1) ? pair >> 4 : pair & 0x0F;
+}
+
+// Write the dirty digits (all with `all`) into the frame buffer, the most
+// significant one at col, row
+void bcdDraw(BcdCounter &counter, uint8_t col, uint8_t row, bool all);
+
+#endif
@@ -0,0 +1,23 @@
+/*
+CRC-8 (Maxim, initial value 0xFF) of the EEPROM records in Persist.h and
+Replay.h.
+*/
+
+#ifndef CRC8_H
+#define CRC8_H
+
+#include <stdint.h>
+
+inline uint8_t crc8(const uint8_t *data, uint8_t length)
+{
+  uint8_t crc = 0xFF;
+  while (length--)
+  {
+    crc ^= *data++;
+    for (uint8_t bit = 0; bit < 8; ++bit)
+      crc = (crc & 1) ? (crc >> 1) ^ 0x8C : crc >> 1;
+  }
+  return crc;
+}
+
+#endif
@@ -0,0 +1,73 @@
+/*
+Shadow frame buffer for the LCD, sized for the build's panel (Geometry.h).
+
+Screens draw into an in-memory copy of the display. flush() compares it with
+what is already on the glass and only sends the cells that changed, one
+setCursor per dirty run.
+
+Fixed text of a screen layout goes through FB_TEXT(col, row, "text"), which
+fails to compile when the text does not fit the panel.
+*/
+
+#ifndef FRAMEBUFFER_H
+#define FRAMEBUFFER_H
+
+#include <stdint.h>
+#include "Geometry.h"
+
+#define FB_COLS Display::cols
+#define FB_ROWS Display::rows
+
+class __FlashStringHelper;
+
+class FrameBuffer
+{
+public:
+  FrameBuffer();
+
+  // Drawing (shadow only, no bus traffic)
+  void clear();
+  void setCursor(uint8_t col, uint8_t row);
+  void write(uint8_t c);
+  void print(const char *text);
+  void print(const __FlashStringHelper *text);
+  void print(unsigned int value);
+  void print(int value);
+  // Flash text at a place known at compile time, see FB_TEXT
+  template <uint8_t Col, uint8_t Row, uint8_t Length>
+  void printAt(const __FlashStringHelper *text)
+  {
+    static_assert(Display::fits(Col, Row, Length), "the layout does not fit the display");
+    setCursor(Col, Row);
+    print(text);
+  }
+
+  // Character drawn at a cell, as the next flush will show it
+  uint8_t at(uint8_t col, uint8_t row) const { return cells[row][col]; }
+
+  // Forget what is on the glass, next flush redraws every cell
+  void invalidate();
+
+  // Send dirty runs to the display, returns bytes sent
+  uint16_t flush();
+
+  // Statistics
+  uint16_t lastFlushBytes() const { return lastBytes; }
+  uint32_t totalBytes() const { return total; }
+  uint16_t flushCount() const { return flushes; }
+
+private:
+  uint8_t cells[FB_ROWS][FB_COLS];
+  uint8_t shown[FB_ROWS][FB_COLS];
+  uint8_t cursorCol;
+  uint8_t cursorRow;
+  uint16_t lastBytes;
+  uint32_t total;
+  uint16_t flushes;
+};
+
+extern FrameBuffer fb;
+
+#define FB_TEXT(col, row, text) fb.printAt<col, row, sizeof(text) - 1>(F(text))
+
+#endif
@@ -0,0 +1,56 @@
+/*
+Fixed-timestep frame scheduler.
+
+Game logic runs at an exact tick rate taken from halMicros(), independent of
+how long rendering takes. When a frame is late the missed logic ticks are
+run back to back and only the last one is rendered, so the game keeps its
+speed and drops renders instead.
+
+  uint8_t ticks = clock.update();
+  while (ticks--)
+    step();          // game logic, draws into fb
+  if (clock.rendered())
+    fb.flush();      // once per batch of ticks
+*/
+
+#ifndef FRAMESCHEDULER_H
+#define FRAMESCHEDULER_H
+
+#include <stdint.h>
+
+// Ticks run in one update() at most, older ones are dropped
+#define SCHEDULER_MAX_CATCH_UP 4
+
+class FrameScheduler
+{
+public:
+  FrameScheduler();
+
+  // Restart the timeline, the first tick is due immediately
+  void start(uint16_t periodMs);
+  // The tick that is already pending moves with the new period
+  void setPeriod(uint16_t periodMs);
+
+  // Number of logic ticks due now, 0 until the next deadline
+  uint8_t update();
+  // True after update() returned ticks that should be rendered
+  bool rendered() const { return renderPending; }
+
+  // Ticks that were late in the last update (0 when on time)
+  uint8_t lastOverrun() const { return lateTicks; }
+  // Totals since start()
+  uint16_t overruns() const { return overrunCount; }
+  uint16_t skippedRenders() const { return skippedCount; }
+  uint16_t droppedTicks() const { return droppedCount; }
+
+private:
+  uint32_t periodUs;
+  uint32_t nextTick;
+  bool renderPending;
+  uint8_t lateTicks;
+  uint16_t overrunCount;
+  uint16_t skippedCount;
+  uint16_t droppedCount;
+};
+
+#endif
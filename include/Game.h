@@ -0,0 +1,77 @@
+/*
+Game modules.
+
+A game is a GameModule: a table of functions the console calls while the
+game is on screen. The modules are listed in the registry in Game.cpp,
+the menu shows them in that order and starts them with Yellow, Green and
+Red; Blue always goes back to the menu.
+
+  init()            taking over the display, draw nothing yet
+  tick(dt, events, count)
+                    dt milliseconds since the last tick, events the
+                    `count` buttons pressed since then, oldest first.
+                    Returns GAME_* flags.
+  render()          draw what changed into the frame buffer (fb)
+  exit()            leaving, back to the menu or on Blue
+
+A tick that returns GAME_ANIMATE is called again on the next loop() pass,
+otherwise only after the next button press. render() follows a tick that
+returned GAME_DRAW, but a tick that takes longer than the module's budget
+drops its render (up to GAME_MAX_DROPPED in a row) so input keeps being
+handled and a slow game loses frames instead of freezing the console.
+*/
+
+#ifndef GAME_H
+#define GAME_H
+
+#include <stdint.h>
+
+// One per menu button
+#define GAME_MAX_MODULES 3
+// Longest menu entry (GameModule::name)
+#define GAME_NAME_LENGTH 5
+// CPU time per tick() when the module sets none
+#define GAME_BUDGET_US 10000
+// Renders dropped in a row before one is forced
+#define GAME_MAX_DROPPED 4
+
+// Presses kept for the next tick, later ones are dropped
+#define GAME_MAX_EVENTS 8
+
+// tick() results
+#define GAME_ANIMATE 1 // Call tick() again without input
+#define GAME_DRAW 2    // Something changed, call render()
+#define GAME_EXIT 4    // Back to the menu
+
+struct GameModule
+{
+  const char *name;  // Menu entry, PROGMEM
+  uint16_t budgetUs; // CPU time per tick(), 0 for GAME_BUDGET_US
+  void (*init)();
+  uint8_t (*tick)(uint16_t dt, const uint8_t *events, uint8_t count);
+  void (*render)();
+  void (*exit)();
+};
+
+// Registry
+uint8_t gameCount();
+const GameModule *gameModule(uint8_t index);
+
+// Runner, drives one module from the state machine
+void gameStart(const GameModule *module);
+void gameEvent(uint8_t button);
+// Run a tick if one is due, returns its GAME_ANIMATE and GAME_EXIT flags
+uint8_t gameUpdate();
+void gameStop();
+
+// For modules with their own logic clock: ticks that ran late this frame
+void gameLate(uint8_t ticks);
+// Renders dropped over budget since the module started
+uint16_t gameDroppedRenders();
+
+// The modules
+extern const GameModule rbrModule;
+extern const GameModule quizModule;
+extern const GameModule infoModule;
+
+#endif
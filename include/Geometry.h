@@ -0,0 +1,57 @@
+/*
+Display geometry.
+
+Geometry<Cols, Rows> describes an HD44780 panel: its size and where each
+row starts in the controller's DDRAM. A build is made for one panel,
+Display, chosen with -DDISPLAY_COLS and -DDISPLAY_ROWS (20x4 by default);
+the frame buffer, the terrain and the screen layouts take their sizes from
+it, so the sizes are constants and a layout that does not fit the panel
+fails to compile (FB_TEXT in FrameBuffer.h). The cursor's DDRAM address
+is only a constant where the row is; the frame buffer flush passes it at
+run time.
+
+Screens that are laid out differently on two-row panels test
+DISPLAY_ROWS in the preprocessor.
+*/
+
+#ifndef GEOMETRY_H
+#define GEOMETRY_H
+
+#include <stdint.h>
+
+template <uint8_t Cols, uint8_t Rows>
+struct Geometry
+{
+  static_assert(Rows == 1 || Rows == 2 || Rows == 4, "HD44780 panels have 1, 2 or 4 rows");
+  // Two DDRAM lines of 40 cells; a 4-row panel splits each in two rows
+  static_assert(Cols > 0 && Cols * (Rows == 4 ? 2 : 1) <= 40, "more columns than the DDRAM holds");
+
+  static constexpr uint8_t cols = Cols;
+  static constexpr uint8_t rows = Rows;
+
+  // DDRAM address of a cell. Odd rows start at 0x40, rows 2 and 3 continue
+  // rows 0 and 1. Computed from the row's bits rather than looked up, so a
+  // constant row folds to a constant address and a variable one costs a
+  // few instructions and no table.
+  static constexpr uint8_t address(uint8_t col, uint8_t row)
+  {
+    return ((row & 1) ? 0x40 : 0) + ((row & 2) ? Cols : 0) + col;
+  }
+
+  // `length` cells from (col, row) are on the panel
+  static constexpr bool fits(uint8_t col, uint8_t row, uint8_t length)
+  {
+    return row < Rows && col + length <= Cols;
+  }
+};
+
+#ifndef DISPLAY_COLS
+#define DISPLAY_COLS 20
+#endif
+#ifndef DISPLAY_ROWS
+#define DISPLAY_ROWS 4
+#endif
+
+typedef Geometry<DISPLAY_COLS, DISPLAY_ROWS> Display;
+
+#endif
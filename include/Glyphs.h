@@ -0,0 +1,41 @@
+/*
+CGRAM glyph cache.
+
+The HD44780 has eight user-defined characters. The glyph bitmaps live in
+flash (Glyphs.cpp) and are asked for by ID: glyphAcquire() returns the
+character code of a CGRAM slot holding the glyph and only uploads it when
+the slot held something else. A slot cannot be reused while it has
+references. Released glyphs stay in CGRAM and are evicted least recently
+used first, so entering a screen again costs no I2C traffic.
+
+Code 0 is the C string terminator, so it is handed out last.
+*/
+
+#ifndef GLYPHS_H
+#define GLYPHS_H
+
+#include <stdint.h>
+
+// Glyph IDs, index into the table in Glyphs.cpp
+#define GLYPH_RUN_1 0
+#define GLYPH_RUN_2 1
+#define GLYPH_JUMP 2
+#define GLYPH_JUMP_LOWER 3
+#define GLYPH_SOLID 4
+#define GLYPH_SOLID_RIGHT 5
+#define GLYPH_SOLID_LEFT 6
+#define GLYPH_COUNT 7
+
+#define GLYPH_SLOTS 8
+// Returned when every slot is referenced. It is the full block of the
+// HD44780 character ROM, so the cell still shows something.
+#define GLYPH_NONE 0xFF
+
+// Character code for the glyph, takes a reference
+uint8_t glyphAcquire(uint8_t glyph);
+void glyphRelease(uint8_t glyph);
+
+// Statistics
+uint16_t glyphUploads();
+
+#endif
@@ -0,0 +1,114 @@
+/*
+Hardware abstraction layer.
+
+The game code only talks to the display, buttons, clock and EEPROM through
+these functions. HalAvr.cpp implements them on the Arduino Nano,
+HalNative.cpp implements them on a Linux host with a mock LCD that records
+frames and scripted button input (pio run -e native).
+*/
+
+#ifndef HAL_H
+#define HAL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "Pin.h"
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <string.h>
+typedef uint8_t byte;
+
+// Flash and RAM are the same address space on the host
+#define PROGMEM
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+#define pgm_read_word(addr) (*(const uint16_t *)(addr))
+#define strlen_P strlen
+class __FlashStringHelper;
+#define F(text) (reinterpret_cast<const __FlashStringHelper *>(text))
+#endif
+
+// Flash string that is not a literal, e.g. a field of a PROGMEM table
+#ifndef FPSTR
+#define FPSTR(p) (reinterpret_cast<const __FlashStringHelper *>(p))
+#endif
+
+// Button pins, all on PORTD. A button is named by its bit there, which is
+// also its Arduino pin number.
+typedef Pin<PortD, 2> PinYellow;
+typedef Pin<PortD, 4> PinGreen;
+typedef Pin<PortD, 3> PinRed;
+typedef Pin<PortD, 5> PinBlue;
+typedef PinGroup<PortD, PinYellow::mask | PinGreen::mask | PinRed::mask | PinBlue::mask> PinButtons;
+
+#define ButtonYellow PinYellow::bit
+#define ButtonGreen PinGreen::bit
+#define ButtonRed PinRed::bit
+#define ButtonBlue PinBlue::bit
+
+// Clock
+uint32_t halMillis();
+uint32_t halMicros();
+void halDelay(uint32_t ms);
+
+// Buttons. The callback runs from the pin-change interrupt on every edge of
+// any button; halButtonLevels() has bit (1 << pin) set for each button that
+// is held down.
+void halButtonsInit(void (*changed)());
+uint8_t halButtonLevels();
+// Keeps the button interrupt out while the main loop runs its handler
+void halButtonsLock();
+void halButtonsUnlock();
+
+// Obstacle hint LED, shares the Red button pin. While it is lit Red reads
+// as released.
+void halLed(bool on);
+
+// Sleep until the next interrupt. Returns at once if a button interrupt
+// fired since the previous call. Timer 0 (millis) keeps running in idle,
+// only a button wakes the MCU from power-down.
+#define HAL_SLEEP_IDLE 0
+#define HAL_SLEEP_POWER_DOWN 1
+void halSleep(uint8_t mode);
+
+// Display
+void halDisplayInit();
+void halDisplayBacklight(bool on);
+void halDisplayPower(bool on);
+void halDisplayCreateChar(uint8_t location, const uint8_t bitmap[]);
+void halDisplaySetCursor(uint8_t col, uint8_t row);
+void halDisplayWrite(const uint8_t *data, uint8_t length);
+uint16_t halDisplayCharsPerMs();
+// Mark everything written so far; halDisplayMarkSent() is true once it has
+// all gone out to the display, with the micros() of that moment
+void halDisplayMark();
+bool halDisplayMarkSent(uint32_t &time);
+
+// EEPROM, 1 KiB. A byte takes about 3.3 ms to program on the AVR, so writes
+// are queued and done from the EEPROM-ready interrupt in order; a write
+// only waits while the queue (HAL_EEPROM_QUEUE - 1 bytes) is full. A read
+// waits until the queue is empty.
+#define HAL_EEPROM_SIZE 1024
+#define HAL_EEPROM_QUEUE 32
+uint8_t halEepromRead(uint16_t address);
+void halEepromWrite(uint16_t address, uint8_t value);
+bool halEepromIdle();
+
+// Some bits of hardware noise for seeding, takes a few milliseconds. The
+// host returns a constant so its runs repeat.
+uint32_t halEntropy();
+
+// Free-running 16-bit timer for telemetry, HAL_TIMER_US microseconds per
+// count, wraps after 262 ms. Timer 1 on the AVR.
+#define HAL_TIMER_US 4
+void halTimerBegin();
+uint16_t halTimer();
+
+// Debug output
+void halSerialBegin(uint32_t baud);
+void halSerialPrint(const char *text);
+void halSerialPrint(uint32_t value);
+void halSerialWrite(const uint8_t *data, uint8_t length);
+
+#endif
@@ -0,0 +1,41 @@
+/*
+Button event queue.
+
+The pin-change interrupt of the four buttons debounces the edges and
+pushes press/release events with their micros() timestamp into a
+single-producer/single-consumer ring buffer. The main loop pops them in
+order, so two presses within one frame are both delivered.
+*/
+
+#ifndef INPUT_H
+#define INPUT_H
+
+#include <stdint.h>
+
+// Power of two, one slot stays free to tell full from empty
+#define INPUT_QUEUE_SIZE 16
+// Edges closer than this to the last accepted edge of a button are bounce
+#define INPUT_DEBOUNCE_US 5000
+
+struct InputEvent
+{
+  uint8_t button; // Button pin number (ButtonYellow...)
+  bool pressed;   // false on release
+  uint32_t time;  // micros() of the edge
+};
+
+// Install the interrupt handler, current levels become the initial state
+void inputBegin();
+// Oldest pending event, false when the queue is empty
+bool inputPop(InputEvent &event);
+// Call from the main loop. Reads the pins again once the debounce window
+// of a dropped edge is over, so a button never sticks on the level of a
+// bounce. True while a button with a dropped edge is still in its window.
+bool inputUpdate();
+
+// Statistics
+uint8_t inputDropped();
+// Longest time an event waited in the queue, in microseconds
+uint32_t inputMaxDelay();
+
+#endif
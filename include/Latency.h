@@ -0,0 +1,63 @@
+/*
+Input-to-display latency.
+
+Build with -DLATENCY to measure how long a button press takes to show on
+the glass, e.g. Yellow to Bob leaving the ground:
+
+  press    the pin-change interrupt stamps the edge (InputEvent.time),
+           pollButtons() hands it over with latencyPress()
+  consume  the game acts on it in a logic tick, latencyConsume()
+  flush    the next FrameBuffer::flush() that sends bytes carries the
+           result; its bytes are marked on the display queue
+  sent     the TWI interrupt stamps the moment the last marked byte is on
+           the bus, latencyUpdate() collects it
+
+The samples go into a histogram of LATENCY_BUCKETS buckets of
+LATENCY_BUCKET_US (the last one takes everything above). Every
+LATENCY_REPORT samples a line with the count, p50 and p99 (upper bucket
+edges, at most the maximum) and the exact maximum in microseconds goes out
+over Serial (115200 baud, stderr on the host build):
+
+  latency n=32 p50=48000 p99=150412 max=150412
+
+Only one press is traced at a time: a press consumed while the previous
+one is still on its way to the display is not sampled. A newer press of
+the same button replaces an unconsumed one.
+
+On the host build display writes take no time, so "sent" is the flush.
+Without LATENCY every function here is an empty inline.
+*/
+
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <stdint.h>
+
+#define LATENCY_BUCKETS 64
+#define LATENCY_BUCKET_US 4000
+#define LATENCY_REPORT 16
+
+#ifdef LATENCY
+
+// A press of `button` (pin number) whose edge was at `time` (micros())
+void latencyPress(uint8_t button, uint32_t time);
+// The game acted on the last press of `button`, the next render shows it
+void latencyConsume(uint8_t button);
+// After every flush that sent `bytes` to the display
+void latencyFlush(uint16_t bytes);
+// Once per loop() pass
+void latencyUpdate();
+// Print the histogram summary now
+void latencyReport();
+
+#else
+
+inline void latencyPress(uint8_t, uint32_t) {}
+inline void latencyConsume(uint8_t) {}
+inline void latencyFlush(uint16_t) {}
+inline void latencyUpdate() {}
+inline void latencyReport() {}
+
+#endif
+
+#endif
@@ -0,0 +1,49 @@
+/*
+Settings and high score kept across power cycles.
+
+EEPROM 0..511 is a journal of fixed-size records written round-robin:
+
+    offset  size
+    0       2    sequence number, one more than the previous record
+    2       2    high score
+    4       4    seed of the last RBR run
+    8       2    RBR tick period at power-on (difficulty)
+    10      1    backlight timeout in seconds
+    11      1    CRC-8 (Maxim, initial value 0xFF) of bytes 0..10
+
+Each save goes to the slot after the previous one, so every cell is
+written only once per PERSIST_SLOTS saves. The sequence number is written
+last: the newest record is the one whose next slot does not continue its
+sequence, and a save cut short by a power loss fails its CRC and leaves
+the previous record in place. Writes go through the EEPROM queue of the
+HAL and never stall the caller.
+*/
+
+#ifndef PERSIST_H
+#define PERSIST_H
+
+#include <stdint.h>
+
+#define PERSIST_EEPROM_START 0
+#define PERSIST_EEPROM_END 512
+#define PERSIST_RECORD_SIZE 12
+#define PERSIST_SLOTS ((PERSIST_EEPROM_END - PERSIST_EEPROM_START) / PERSIST_RECORD_SIZE)
+
+struct PersistData
+{
+  uint16_t highScore;
+  uint32_t seed;
+  uint16_t startSpeed;
+  uint8_t backlight;
+};
+
+// The console's settings, loaded by setup() in main.cpp
+extern PersistData settings;
+
+// Load the newest valid record. Returns false and leaves `data` alone if
+// there is none.
+bool persistBegin(PersistData &data);
+// Journal `data` if it differs from the last record
+void persistSave(const PersistData &data);
+
+#endif
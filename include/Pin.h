@@ -0,0 +1,125 @@
+/*
+Compile-time GPIO.
+
+Pin<Port, Bit> is one pin of PortB, PortC or PortD. Port and bit are
+template arguments, so register and mask are constants at every call
+instead of being looked up in flash tables like digitalWrite() and
+digitalRead() do. -DGPIO_BENCH compares the two on a board.
+PinGroup<Port, Mask> reads several pins of one port with a single read,
+so their levels are sampled at the same instant.
+
+On the host the registers are plain bytes (pinPortB..D) that HalNative.cpp
+drives from the button script.
+*/
+
+#ifndef PIN_H
+#define PIN_H
+
+#include <stdint.h>
+
+#ifdef ARDUINO
+#include <avr/io.h>
+
+#define PIN_PORT(name, letter)                                 \
+  struct name                                                  \
+  {                                                            \
+    static volatile uint8_t &in() { return PIN##letter; }      \
+    static volatile uint8_t &dir() { return DDR##letter; }     \
+    static volatile uint8_t &out() { return PORT##letter; }    \
+    /* Writing ones to PINx toggles those PORTx bits */        \
+    static void toggle(uint8_t mask) { PIN##letter = mask; }   \
+  };
+#else
+// PINx, DDRx and PORTx of one port
+struct PinMockPort
+{
+  uint8_t in;
+  uint8_t dir;
+  uint8_t out;
+};
+extern PinMockPort pinPortB, pinPortC, pinPortD;
+
+#define PIN_PORT(name, letter)                                        \
+  struct name                                                         \
+  {                                                                   \
+    static uint8_t &in() { return pinPort##letter.in; }               \
+    static uint8_t &dir() { return pinPort##letter.dir; }             \
+    static uint8_t &out() { return pinPort##letter.out; }             \
+    static void toggle(uint8_t mask) { pinPort##letter.out ^= mask; } \
+  };
+#endif
+
+PIN_PORT(PortB, B)
+PIN_PORT(PortC, C)
+PIN_PORT(PortD, D)
+
+template <class Port, uint8_t Bit>
+struct Pin
+{
+  static_assert(Bit < 8, "a port has 8 pins");
+
+  static constexpr uint8_t bit = Bit;
+  static constexpr uint8_t mask = 1 << Bit;
+
+  // Floating input
+  static void input()
+  {
+    Port::dir() &= ~mask;
+    Port::out() &= ~mask;
+  }
+
+  // Input held high by the internal pull-up
+  static void inputPullup()
+  {
+    Port::dir() &= ~mask;
+    Port::out() |= mask;
+  }
+
+  // Drives the level last written, set it before to avoid a glitch
+  static void output()
+  {
+    Port::dir() |= mask;
+  }
+
+  static void high()
+  {
+    Port::out() |= mask;
+  }
+
+  static void low()
+  {
+    Port::out() &= ~mask;
+  }
+
+  static void write(bool level)
+  {
+    if (level)
+      high();
+    else
+      low();
+  }
+
+  static void toggle()
+  {
+    Port::toggle(mask);
+  }
+
+  static bool read()
+  {
+    return Port::in() & mask;
+  }
+};
+
+template <class Port, uint8_t Mask>
+struct PinGroup
+{
+  static constexpr uint8_t mask = Mask;
+
+  // Levels of the group's pins, the other bits are 0
+  static uint8_t read()
+  {
+    return Port::in() & Mask;
+  }
+};
+
+#endif
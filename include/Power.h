@@ -0,0 +1,38 @@
+/*
+Idle manager.
+
+Called once per loop(). While a state is animating the MCU naps in idle
+sleep between timer interrupts. After the configured time without input
+the backlight and then the display are switched off; once nothing is
+animating and no timeout is pending the MCU goes to power-down and only a
+button wakes it up: all four are on the PORTD pin-change interrupt
+(PCINT2), which works in power-down.
+
+Build with -DPOWER_STATS to print per state the time awake and a current
+estimate over Serial. The estimate weights typical datasheet currents by
+the measured sleep times; it is not a measurement of the board.
+*/
+
+#ifndef POWER_H
+#define POWER_H
+
+#include <stdint.h>
+
+// Default timeouts in seconds, 0 disables
+#define POWER_BACKLIGHT_TIMEOUT 25
+#define POWER_DISPLAY_TIMEOUT 120
+
+// States tracked by the statistics
+#define POWER_MAX_STATES 8
+
+void powerBegin();
+void powerSetTimeouts(uint16_t backlightSeconds, uint16_t displaySeconds);
+// Call for every button press. Returns false when the press only woke the
+// display up and should not be handled any further.
+bool powerActivity();
+// False while the display is off, nothing needs to be drawn then
+bool powerDisplayOn();
+// Sleep until the next thing to do
+void powerIdle(uint8_t state, bool animating);
+
+#endif
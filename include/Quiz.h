@@ -0,0 +1,43 @@
+/*
+Quiz.
+
+The questions come from the compressed pack in flash (QuizPack.h). A round
+asks QUIZ_ROUND of them, in a new random order each time. The caller feeds
+answers and draws the screen of the new state with quizDraw()
+(QuizModule.cpp).
+*/
+
+#ifndef QUIZ_H
+#define QUIZ_H
+
+#include <stdint.h>
+#include "Geometry.h"
+
+// The questions are written for 20x4 panels, smaller builds go without the
+// quiz
+#define QUIZ_FITS_DISPLAY (DISPLAY_COLS >= 20 && DISPLAY_ROWS >= 4)
+
+// Questions per round, fewer if the pack has fewer
+#define QUIZ_ROUND 10
+
+// Answer sides, Red answers left and Yellow answers right
+#define QUIZ_LEFT 0
+#define QUIZ_RIGHT 1
+
+// Quiz states
+#define QUIZ_INTRO 0    // Instructions on screen
+#define QUIZ_ASKING 1   // Waiting for an answer
+#define QUIZ_WRONG 2    // Bad answer, play again or go home
+#define QUIZ_FINISHED 3 // All questions answered
+
+// Back to the instructions and the first question
+void quizBegin();
+// Leave the instructions and ask the first question
+void quizContinue();
+// Answer the current question, returns the new state
+uint8_t quizAnswer(uint8_t side);
+uint8_t quizState();
+// Draw the screen of the current state into the frame buffer
+void quizDraw();
+
+#endif
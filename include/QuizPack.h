@@ -0,0 +1,58 @@
+/*
+Compressed quiz questions in flash.
+
+tools/quizc.py compiles assets/quiz.txt into src/QuizPackData.cpp. Each
+question is four lines (two prompt lines, left and right answer) coded as
+a stream of symbols:
+
+  0        end of line
+  1..95    the characters ' '..'~'
+  96..     a dictionary entry, a substring that is common in the questions
+
+The symbols are Huffman coded with a canonical code, so the decoder only
+needs the number of codes of each length and the symbols in code order.
+A question starts on a byte boundary, the table of contents holds its
+offset, the correct side and the length of the right answer (it is drawn
+right-aligned). Lines are decoded straight into the frame buffer, no line
+is ever held in SRAM; a line costs at most FB_COLS symbols of
+QUIZ_PACK_MAX_BITS bits.
+*/
+
+#ifndef QUIZPACK_H
+#define QUIZPACK_H
+
+#include <stdint.h>
+
+#define QUIZ_PACK_MAX_BITS 15
+#define QUIZ_PACK_END 0
+#define QUIZ_PACK_CHAR 1
+#define QUIZ_PACK_WORD 96
+
+// Position in the bit stream
+struct QuizPackReader
+{
+  uint16_t byte;
+  uint8_t bit;
+};
+
+uint16_t quizPackCount();
+// QUIZ_LEFT or QUIZ_RIGHT
+uint8_t quizPackCorrect(uint16_t question);
+uint8_t quizPackRightLength(uint16_t question);
+
+// Point the reader at the first line of a question
+void quizPackOpen(QuizPackReader &reader, uint16_t question);
+// Decode the next line into the frame buffer at its cursor, returns the
+// characters written
+uint8_t quizPackLine(QuizPackReader &reader);
+
+// Generated tables (QuizPackData.cpp)
+extern const uint16_t quizPackQuestions;
+extern const uint8_t quizPackToc[];
+extern const uint8_t quizPackCodeLengths[QUIZ_PACK_MAX_BITS];
+extern const uint8_t quizPackSymbols[];
+extern const char quizPackWords[];
+extern const uint16_t quizPackWordOffsets[];
+extern const uint8_t quizPackBits[];
+
+#endif
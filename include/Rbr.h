@@ -0,0 +1,47 @@
+/*
+Game "RBR" (Run Bob Run).
+
+The console's game. A run only depends on the seed of its RNG, the ticks
+at which the jump button was pressed and the state carried over from the
+previous run, so it can be recorded and replayed (see Replay.h). The rules
+are in RbrGame.h; timing and input stay with the caller (RbrModule.cpp,
+Replay.cpp), the rbrDraw* functions draw into the frame buffer.
+*/
+
+#ifndef RBR_H
+#define RBR_H
+
+#include <stdint.h>
+#include "RbrGame.h"
+
+// Take the CGRAM slots of the sprites while RBR is on screen, uploading
+// only what is not there already
+void rbrAcquireGlyphs();
+void rbrReleaseGlyphs();
+
+// Empty playfield, hero on the ground, RNG seeded with `seed`
+void rbrNewGame(uint32_t seed);
+void rbrClearScore();
+
+// One logic tick, false when the hero collided
+bool rbrStep(bool jump);
+
+// The pose of the last tick, the hero's collision pose after the last one
+void rbrDrawStep();
+// Playfield and score, without running a tick. On two rows the distance
+// is left out for the attract screen text.
+void rbrDraw(bool hero);
+void rbrDrawTopScore();
+
+// Milliseconds per tick at the current level
+uint16_t rbrTickPeriod();
+uint16_t rbrDistance();
+// Obstacle two cells in front of the hero
+bool rbrObstacleAhead();
+// The hero left the ground in the last tick
+bool rbrTookOff();
+
+void rbrSaveCarry(RbrCarry &carry);
+void rbrLoadCarry(const RbrCarry &carry);
+
+#endif
@@ -0,0 +1,109 @@
+/*
+RBR rules without any I/O.
+
+The console (Rbr.cpp) runs one game and draws it, the host simulator
+(src/sim) runs many in parallel. The terrain does not depend on the hero,
+and the hero only looks at its own column, so a tick can be split into
+rbrTerrainStep() and the three rbrHero*() steps to search over jumps.
+*/
+
+#ifndef RBR_GAME_H
+#define RBR_GAME_H
+
+#include <stdint.h>
+#include "Rng.h"
+#include "Terrain.h"
+
+#define RBR_START_SPEED 150
+#define RBR_HERO_COLUMN 1 // Horizontal position of hero on screen
+
+#define TERRAIN_EMPTY 0
+#define TERRAIN_LOWER_BLOCK 1
+#define TERRAIN_UPPER_BLOCK 2
+
+// Ticks on the upper row in the longest jump. The jump arc itself is
+// described in RbrGame.cpp, the tables are generated from it.
+#define RBR_JUMP_HANG_MAX 6
+#define RBR_JUMP_FRAMES (4 + RBR_JUMP_HANG_MAX) // Two up, the hang, two down
+
+#define HERO_POSITION_OFF 0         // Hero is invisible
+#define HERO_POSITION_RUN_LOWER_1 1 // Hero is running on lower row (pose 1)
+#define HERO_POSITION_RUN_LOWER_2 2 //                              (pose 2)
+#define HERO_POSITION_JUMP_1 3      // First frame of the jump arc
+#define HERO_POSITION_RUN_UPPER_1 (HERO_POSITION_JUMP_1 + RBR_JUMP_FRAMES) // Running on upper row
+#define HERO_POSITION_RUN_UPPER_2 (HERO_POSITION_RUN_UPPER_1 + 1)
+#define HERO_POSITIONS (HERO_POSITION_RUN_UPPER_2 + 1)
+
+// What a position shows in each row
+#define HERO_SPRITE_NONE 0
+#define HERO_SPRITE_RUN_1 1
+#define HERO_SPRITE_RUN_2 2
+#define HERO_SPRITE_JUMP 3
+#define HERO_SPRITE_JUMP_LOWER 4 // Body of a jump across both rows
+#define HERO_SPRITE_HEAD 5       // Head of a jump across both rows
+#define HERO_SPRITES 6
+
+// Terrain generator and level parameters
+struct RbrTuning
+{
+  uint8_t upperOdds;      // 1 in upperOdds blocks is an upper one
+  uint8_t blockMin;       // Block length is blockMin + [0, blockRange)
+  uint8_t blockRange;     // half cells
+  uint8_t gapMin;         // Gap length is gapMin + [0, gapRange)
+  uint8_t gapRange;
+  uint8_t stagesPerLevel; // Ticks per level
+  uint8_t jumpHang;       // Ticks on the upper row, 1..RBR_JUMP_HANG_MAX
+};
+
+extern const RbrTuning rbrDefaultTuning;
+
+// The game speeds up for good with every level and the top score stays,
+// so both carry over from one run to the next
+struct RbrCarry
+{
+  uint16_t speed; // Milliseconds per tick
+  uint8_t stage;
+  uint16_t highScore;
+};
+
+struct RbrGame
+{
+  const RbrTuning *tuning;
+  RbrCarry carry;
+  uint8_t hero; // Position for the next tick
+  uint8_t pose; // Position shown in the last tick
+  Rng rng;
+  TerrainRow upper;
+  TerrainRow lower;
+  uint8_t terrainType;
+  uint8_t terrainDuration;
+  uint16_t distance;
+  uint16_t level;
+};
+
+// Empty playfield, hero on the ground, RNG seeded with `seed`. The carry
+// is left alone.
+void rbrGameNew(RbrGame &game, uint32_t seed);
+
+// One tick, false when the hero collided
+bool rbrGameStep(RbrGame &game, bool jump);
+
+// Scroll the terrain and generate what enters on the right
+void rbrTerrainStep(RbrGame &game);
+
+// Pose for this tick, a jump only starts from the ground
+inline uint8_t rbrHeroJump(uint8_t hero, bool jump)
+{
+  return (jump && hero <= HERO_POSITION_RUN_LOWER_2) ? HERO_POSITION_JUMP_1 : hero;
+}
+
+// HERO_SPRITE_* of the upper row << 4 | of the lower row
+uint8_t rbrHeroSprites(uint8_t pose);
+
+// Whether the pose overlaps solid terrain in the hero column
+bool rbrHeroCollides(uint8_t pose, bool upperSolid, bool lowerSolid);
+
+// Position for the next tick, in a jump of `hang` ticks on the upper row
+uint8_t rbrHeroNext(uint8_t pose, bool lowerSolid, uint8_t hang);
+
+#endif
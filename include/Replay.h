@@ -0,0 +1,75 @@
+/*
+RBR run recorder and player.
+
+The upper half of the EEPROM is a ring of REPLAY_SLOTS slots. Each run is
+recorded from the start of the first slot after the end of the previous
+one, so recordings go round the ring and a cell is written once per lap
+instead of once per run. A run is stored as
+
+    offset  size
+    0       2    magic "RB"
+    2       1    format version
+    3       2    sequence number, one more than the previous run
+    5       4    RNG seed
+    9       2    speed at the start of the run (RbrCarry)
+    11      1    stage
+    12      2    top score
+    14      2    distance reached, to check a replay against
+    16      1    CRC-8 (Maxim, initial value 0xFF) of bytes 0..15
+    17      ...  one entry per jump: ticks since the previous jump (or the
+                 start) plus one, 7 bits per byte, low bits first, bit 7
+                 set on all but the last byte
+    ...     1    0, end of the run
+
+Offsets past the end of the ring continue at its start, and a run may use
+the whole ring but its own header. All values are little endian. The
+magic is cleared when a recording starts and the header is only written,
+magic last, once the run ended, so a run that was aborted or did not fit
+leaves no recording behind. A new run reaches the header of an older one
+before its jumps, so a header that is still valid has all of them. The
+last run is the valid header with the highest sequence number.
+*/
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <stdint.h>
+#include "Rbr.h"
+
+#define REPLAY_EEPROM_START 512
+#define REPLAY_EEPROM_END 1024
+#define REPLAY_SLOT_SIZE 16
+#define REPLAY_SLOTS ((REPLAY_EEPROM_END - REPLAY_EEPROM_START) / REPLAY_SLOT_SIZE)
+#define REPLAY_HEADER_SIZE 17
+// 3: runs in a ring of slots. The terrain width changes the run, other
+// widths than 20 are written as 0xC0 | width and only replay there.
+#define REPLAY_VERSION (TERRAIN_WIDTH == 20 ? 3 : 0xC0 | TERRAIN_WIDTH)
+
+struct ReplayHeader
+{
+  uint32_t seed;
+  RbrCarry carry;
+  uint16_t distance;
+};
+
+// Find the last run and where the next one goes, before anything else
+void replayBegin();
+
+// Recording, call replayRecordTick() once per logic tick
+void replayRecordBegin(const ReplayHeader &header);
+void replayRecordTick(bool jump);
+void replayRecordEnd(uint16_t distance);
+
+// Playback of the last run, false if there is no valid recording
+bool replayPlayBegin(ReplayHeader &header);
+// Whether the jump button was pressed in the next tick
+bool replayPlayTick();
+
+// Recording as hex over Serial
+void replayDump();
+
+// Play the recording without waiting for the tick period and report
+// whether it reached the recorded distance
+bool replayRun();
+
+#endif
@@ -0,0 +1,36 @@
+/*
+Seedable pseudo random numbers (xorshift16).
+
+Arduino random() cannot be reproduced on the host and gives no way to
+restart a sequence, which replays need. The generator here is a 16-bit
+xorshift (shifts 7, 9, 8, period 65535) and rngBelow() scales with one
+multiply instead of a modulo; -DRNG_BENCH compares both with random() on
+a board. The state is passed in, so the host simulator can run one
+generator per game.
+
+Seeds come from an entropy pool: noise read at boot (halEntropy()) and the
+timing of every button press are stirred in.
+*/
+
+#ifndef RNG_H
+#define RNG_H
+
+#include <stdint.h>
+
+struct Rng
+{
+  uint16_t state;
+};
+
+// The seed is folded to 16 bits. Zero is replaced, xorshift would stay at
+// zero.
+void rngSeed(Rng &rng, uint32_t seed);
+uint16_t rngNext(Rng &rng);
+// Number in [0, max)
+uint8_t rngBelow(Rng &rng, uint8_t max);
+
+// Entropy pool
+void rngStir(uint32_t value);
+uint32_t rngPool();
+
+#endif
@@ -0,0 +1,38 @@
+/*
+Stack high-water mark.
+
+The free SRAM between the heap and the stack is painted with a fill byte.
+The stack only ever overwrites the paint from the top down, so the paint
+left intact at the bottom is the least free SRAM since the last paint.
+
+Build with -DSTACK_MONITOR to print over Serial (115200 baud), whenever
+the state changes, the deepest stack of the session that just ended and
+of all sessions of that state so far. Each session starts with a fresh
+paint. On the host there is no SRAM to measure and everything reads 0.
+*/
+
+#ifndef STACK_H
+#define STACK_H
+
+#include <stdint.h>
+
+// States tracked by the monitor
+#define STACK_MAX_STATES 8
+
+// Paint everything between the heap and the current stack pointer
+void stackPaint();
+// Bytes between the heap and the stack now
+uint16_t stackFree();
+// Fewest bytes between the heap and the stack since stackPaint()
+uint16_t stackFreeMin();
+// Bytes from the top of SRAM down to the deepest stack since stackPaint()
+uint16_t stackDepth();
+
+#ifdef STACK_MONITOR
+// Call once per loop() pass with the current state
+void stackMonitor(uint8_t state);
+#else
+inline void stackMonitor(uint8_t) {}
+#endif
+
+#endif
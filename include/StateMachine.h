@@ -0,0 +1,37 @@
+/*
+Application state machine.
+
+Every screen is a state with optional entry, event, update and exit
+actions. enter() draws the screen once, event() handles a button press,
+exit() cleans up before the next state is entered. Only states that
+animate have an update(); it returns true while it still needs to be
+called. A state without pending updates is idle and costs nothing until
+the next button event.
+*/
+
+#ifndef STATEMACHINE_H
+#define STATEMACHINE_H
+
+#include <stdint.h>
+
+struct State
+{
+  void (*enter)();
+  void (*event)(uint8_t button);
+  bool (*update)();
+  void (*exit)();
+};
+
+// Start in the given state of the table
+void smBegin(const State *table, uint8_t first);
+// Exit the current state and enter the next one, safe to call from actions
+void smGoto(uint8_t state);
+// Pass a button press (button pin number) to the current state
+void smDispatch(uint8_t button);
+// Run the current state's update if it has one pending
+void smUpdate();
+// True when the current state waits for input only
+bool smIdle();
+uint8_t smState();
+
+#endif
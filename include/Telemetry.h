@@ -0,0 +1,74 @@
+/*
+Frame telemetry over Serial.
+
+Build with -DTELEMETRY to time the hot paths with Timer 1 (4 us per count)
+and send one fixed-size binary packet per frame. A frame is a loop() pass
+that did any work: handled a button, stepped or drew RBR, or sent bytes to
+the LCD. Passes that only slept are not reported. The menu is drawn by its
+button handler, so its drawing counts as input; only RBR times its
+render(). tools/telemetry.py decodes the stream into per-second statistics
+and CSV.
+
+Packet, 24 bytes, little-endian:
+
+  0  0xA5 0x5A  sync
+  2  sequence   uint8, +1 per packet
+  3  state      uint8, smState()
+  4  ms         uint16, halMillis() at the end of the frame
+  6  frame      uint16, counts from loop() start to the end of the frame
+  8  sections   uint16 x 4, counts in input, terrain, render and flush
+  16 lcd        uint16, bytes sent to the LCD
+  18 free       uint16, bytes between heap and stack now
+  20 freeMin    uint16, the same at the deepest stack so far (of this
+                state session with STACK_MONITOR, see Stack.h)
+  22 late       uint8, RBR logic ticks that ran late
+  23 checksum   uint8, sum of bytes 2..22
+
+Without TELEMETRY every function here is an empty inline and costs nothing.
+*/
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+
+#define TELEMETRY_BAUD 1000000
+
+// Sections
+#define TELEMETRY_INPUT 0
+#define TELEMETRY_TERRAIN 1
+#define TELEMETRY_RENDER 2
+#define TELEMETRY_FLUSH 3
+#define TELEMETRY_SECTIONS 4
+
+#define TELEMETRY_PACKET_SIZE 24
+
+#ifdef TELEMETRY
+
+// Starts the timer and the serial port, paints the free stack
+void telemetryBegin();
+// Timestamp for telemetryAdd()
+uint16_t telemetryTime();
+// Add the time since `since` to a section of this frame
+void telemetryAdd(uint8_t section, uint16_t since);
+// A flush that sent `bytes` to the LCD
+void telemetryFlush(uint16_t since, uint16_t bytes);
+// Logic ticks that were late for this frame's render
+void telemetryLate(uint8_t ticks);
+// Around every loop() pass
+void telemetryFrameBegin();
+void telemetryFrameEnd(uint8_t state);
+
+#else
+
+inline void telemetryBegin() {}
+inline uint16_t telemetryTime() { return 0; }
+inline void telemetryAdd(uint8_t, uint16_t) {}
+inline void telemetryFlush(uint16_t, uint16_t) {}
+inline void telemetryLate(uint8_t) {}
+inline void telemetryFrameBegin() {}
+inline void telemetryFrameEnd(uint8_t) {}
+
+#endif
+
+#endif
@@ -0,0 +1,56 @@
+/*
+RBR playfield, one bit per half cell.
+
+Terrain scrolls by half a cell per tick, which is what the SOLID_LEFT and
+SOLID_RIGHT edge sprites show. Each row therefore keeps two masks: bit i of
+`left` is the left half of cell i, bit i of `right` its right half. A tick
+moves every right half into the left half of the same cell and every left
+half into the right half of the cell to its left, so scrolling is a shift
+and collision is a bit test. Which edge of a cell is solid is only worked
+out when the cell is drawn.
+*/
+
+#ifndef TERRAIN_H
+#define TERRAIN_H
+
+#include <stdint.h>
+#include "Geometry.h"
+
+// One cell per display column
+#define TERRAIN_WIDTH Display::cols
+static_assert(TERRAIN_WIDTH <= 32, "a terrain row is a 32-bit mask");
+
+// What a cell shows, bit 1 its left half, bit 0 its right half
+#define TERRAIN_CELL_EMPTY 0
+#define TERRAIN_CELL_SOLID_RIGHT 1
+#define TERRAIN_CELL_SOLID_LEFT 2
+#define TERRAIN_CELL_SOLID 3
+#define TERRAIN_CELLS 4
+
+struct TerrainRow
+{
+  uint32_t left;
+  uint32_t right;
+};
+
+// Scroll half a cell to the left, `solid` enters on the right edge
+inline void terrainAdvance(TerrainRow &row, bool solid)
+{
+  uint32_t left = row.left;
+  row.left = row.right;
+  row.right = (left >> 1) | ((uint32_t)solid << (TERRAIN_WIDTH - 1));
+}
+
+// Any part of the cell is solid
+inline bool terrainSolid(const TerrainRow &row, uint8_t cell)
+{
+  return ((row.left | row.right) >> cell) & 1;
+}
+
+// TERRAIN_CELL_* from the two halves of a cell
+inline uint8_t terrainCell(bool leftHalf, bool rightHalf)
+{
+  return (leftHalf << 1) | rightHalf;
+}
+
+#endif
@@ -0,0 +1,224 @@
+#include "LcdI2C.h"
+
+// HD44780 commands
+#define LCD_CLEARDISPLAY 0x01
+#define LCD_RETURNHOME 0x02
+#define LCD_ENTRYMODESET 0x04
+#define LCD_DISPLAYCONTROL 0x08
+#define LCD_FUNCTIONSET 0x20
+#define LCD_SETCGRAMADDR 0x40
+#define LCD_SETDDRAMADDR 0x80
+
+#define LCD_ENTRYLEFT 0x02
+#define LCD_DISPLAYON 0x04
+#define LCD_4BITMODE 0x00
+#define LCD_2LINE 0x08
+#define LCD_5x8DOTS 0x00
+
+// PCF8574 pins
+#define PIN_RS 0x01
+#define PIN_EN 0x04
+#define PIN_BACKLIGHT 0x08
+
+LcdI2C::LcdI2C(uint8_t address, uint8_t cols, uint8_t rows)
+    : addr(address), numCols(cols), numRows(rows), displayControl(LCD_DISPLAYON),
+      backlightBit(PIN_BACKLIGHT), pendingLength(0), chars(0),
+      windowChars(0), windowBusy(0)
+{
+}
+
+void LcdI2C::init()
+{
+  twiBegin(LCD_I2C_CLOCK);
+
+  // Power-on wait, then the datasheet's 4-bit reset sequence
+  delay(50);
+  queue(backlightBit);
+  wait();
+  delay(1000);
+  writeNibble(0x30);
+  wait();
+  delayMicroseconds(4500);
+  writeNibble(0x30);
+  wait();
+  delayMicroseconds(4500);
+  writeNibble(0x30);
+  wait();
+  delayMicroseconds(150);
+  writeNibble(0x20);
+
+  command(LCD_FUNCTIONSET | LCD_4BITMODE | LCD_2LINE | LCD_5x8DOTS);
+  command(LCD_DISPLAYCONTROL | displayControl);
+  command(LCD_ENTRYMODESET | LCD_ENTRYLEFT);
+  clear();
+}
+
+void LcdI2C::clear()
+{
+  command(LCD_CLEARDISPLAY);
+  wait();
+  delayMicroseconds(2000); // Slow command
+}
+
+void LcdI2C::home()
+{
+  command(LCD_RETURNHOME);
+  wait();
+  delayMicroseconds(2000); // Slow command
+}
+
+void LcdI2C::setCursor(uint8_t col, uint8_t row)
+{
+  if (row >= numRows)
+  {
+    row = numRows - 1;
+  }
+  // Rows 2 and 3 continue rows 0 and 1 in DDRAM
+  uint8_t offset = (row & 1) ? 0x40 : 0x00;
+  if (row & 2)
+  {
+    offset += numCols;
+  }
+  setAddress(col + offset);
+}
+
+void LcdI2C::setAddress(uint8_t address)
+{
+  // Queued only, it goes out together with the characters that follow
+  command(LCD_SETDDRAMADDR | address);
+}
+
+void LcdI2C::display()
+{
+  displayControl |= LCD_DISPLAYON;
+  command(LCD_DISPLAYCONTROL | displayControl);
+  flush();
+}
+
+void LcdI2C::noDisplay()
+{
+  displayControl &= ~LCD_DISPLAYON;
+  command(LCD_DISPLAYCONTROL | displayControl);
+  flush();
+}
+
+void LcdI2C::backlight()
+{
+  backlightBit = PIN_BACKLIGHT;
+  queue(backlightBit);
+  flush();
+}
+
+void LcdI2C::noBacklight()
+{
+  backlightBit = 0;
+  queue(backlightBit);
+  flush();
+}
+
+void LcdI2C::createChar(uint8_t location, const uint8_t charmap[])
+{
+  command(LCD_SETCGRAMADDR | ((location & 0x7) << 3));
+  for (uint8_t i = 0; i < 8; ++i)
+  {
+    send(charmap[i], PIN_RS);
+  }
+  flush();
+}
+
+size_t LcdI2C::write(uint8_t value)
+{
+  send(value, PIN_RS);
+  chars++;
+  flush();
+  return 1;
+}
+
+size_t LcdI2C::write(const uint8_t *buffer, size_t size)
+{
+  for (size_t i = 0; i < size; ++i)
+  {
+    send(buffer[i], PIN_RS);
+  }
+  chars += size;
+  flush();
+  return size;
+}
+
+void LcdI2C::flush()
+{
+  if (pendingLength == 0)
+  {
+    return;
+  }
+  twiWrite(addr, pending, pendingLength);
+  pendingLength = 0;
+#ifdef LCD_TWI_SYNC
+  twiWait();
+#endif
+}
+
+void LcdI2C::wait()
+{
+  flush();
+  twiWait();
+}
+
+void LcdI2C::mark()
+{
+  flush();
+  twiMark();
+}
+
+bool LcdI2C::idle() const
+{
+  return pendingLength == 0 && twiIdle();
+}
+
+uint16_t LcdI2C::charsPerMs()
+{
+  // Differences since the last reading stay right when the totals wrap
+  uint32_t busy = twiBusyMicros() - windowBusy;
+  uint32_t sent = chars - windowChars;
+  if (busy == 0)
+  {
+    return 0;
+  }
+  windowBusy += busy;
+  windowChars = chars;
+  // Halve both until sent * 1000 fits
+  while (sent > 0xFFFFFFFFUL / 1000)
+  {
+    sent >>= 1;
+    busy >>= 1;
+  }
+  return busy ? (uint16_t)((sent * 1000UL) / busy) : 0xFFFF;
+}
+
+void LcdI2C::command(uint8_t value)
+{
+  send(value, 0);
+}
+
+void LcdI2C::send(uint8_t value, uint8_t mode)
+{
+  writeNibble((value & 0xF0) | mode);
+  writeNibble(((value << 4) & 0xF0) | mode);
+}
+
+void LcdI2C::writeNibble(uint8_t bits)
+{
+  // Data is latched on the falling edge of EN. At 100-400 kHz every expander
+  // byte lasts well over the HD44780 setup, pulse and execution times.
+  queue(bits | PIN_EN);
+  queue(bits);
+}
+
+void LcdI2C::queue(uint8_t bits)
+{
+  if (pendingLength == LCD_I2C_BUFFER)
+  {
+    flush();
+  }
+  pending[pendingLength++] = bits | backlightBit;
+}
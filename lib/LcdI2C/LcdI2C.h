@@ -0,0 +1,88 @@
+/*
+HD44780 driver for the PCF8574 I2C backpack.
+
+Drop-in replacement for LiquidCrystal_I2C (same init/setCursor/print/createChar
+API). Instead of one transaction per nibble, the strobe sequence of many
+characters is packed into a single transmission. Transmissions go to the
+interrupt-driven TwiQueue, so drawing returns before the bytes are on the
+bus; build with -DLCD_TWI_SYNC to wait for every transmission instead (the
+old blocking behaviour, to compare frame times).
+
+Backpack wiring: P0 RS, P1 RW, P2 EN, P3 backlight, P4..P7 D4..D7
+*/
+
+#ifndef LCDI2C_H
+#define LCDI2C_H
+
+#include <Arduino.h>
+#include <Print.h>
+#include <TwiQueue.h>
+
+// I2C clock, 400000 enables fast mode
+#ifndef LCD_I2C_CLOCK
+#define LCD_I2C_CLOCK 100000
+#endif
+
+// Expander bytes per transmission, at most TWI_MAX_WRITE. 1 sends every
+// byte on its own like LiquidCrystal_I2C, the reference for charsPerMs()
+#ifndef LCD_I2C_BUFFER
+#define LCD_I2C_BUFFER 32
+#endif
+
+class LcdI2C : public Print
+{
+public:
+  LcdI2C(uint8_t address, uint8_t cols, uint8_t rows);
+
+  void init();
+  void clear();
+  void home();
+  void setCursor(uint8_t col, uint8_t row);
+  // Cursor to a DDRAM address, for callers that know the panel's row
+  // offsets at compile time
+  void setAddress(uint8_t address);
+  void display();
+  void noDisplay();
+  void backlight();
+  void noBacklight();
+  void createChar(uint8_t location, const uint8_t charmap[]);
+
+  virtual size_t write(uint8_t value);
+  virtual size_t write(const uint8_t *buffer, size_t size);
+  using Print::write;
+
+  // Hand everything still buffered to the TWI queue
+  virtual void flush();
+  // Wait until the display received everything
+  void wait();
+  bool idle() const;
+  // Mark what was written so far, markSent() is true once it is out
+  void mark();
+  bool markSent(uint32_t &time) const { return twiMarkSent(time); }
+
+  // Throughput of the transport: totals since init(), charsPerMs() since
+  // its previous call
+  uint32_t charsSent() const { return chars; }
+  uint32_t busyMicros() const { return twiBusyMicros(); }
+  uint16_t charsPerMs();
+
+private:
+  void command(uint8_t value);
+  void send(uint8_t value, uint8_t mode);
+  void queue(uint8_t bits);
+  void writeNibble(uint8_t bits);
+
+  uint8_t addr;
+  uint8_t numCols;
+  uint8_t numRows;
+  uint8_t displayControl;
+  uint8_t backlightBit;
+  uint8_t pending[LCD_I2C_BUFFER];
+  uint8_t pendingLength;
+  uint32_t chars;
+  // charsSent() and busyMicros() at the previous charsPerMs()
+  uint32_t windowChars;
+  uint32_t windowBusy;
+};
+
+#endif
@@ -0,0 +1,192 @@
+#include "TwiQueue.h"
+#include <util/twi.h>
+
+#define MASK (TWI_QUEUE_SIZE - 1)
+
+// Keeps the compiler from moving queue writes across the index update
+#define BARRIER() __asm__ __volatile__("" ::: "memory")
+
+// Interrupt acknowledged, bus kept going
+#define TWCR_NEXT (_BV(TWINT) | _BV(TWEN) | _BV(TWIE))
+
+static uint8_t queue[TWI_QUEUE_SIZE];
+// head is only written by the main loop, tail only by the interrupt
+static volatile uint8_t head = 0;
+static volatile uint8_t tail = 0;
+static volatile bool active = false;
+
+// Transmission in progress, only touched by the interrupt
+static uint8_t remaining = 0;
+
+// Transmissions end exactly at markAt, the interrupt stamps that one
+static volatile uint8_t markAt = 0;
+static volatile bool markPending = false;
+static volatile bool markSent = false;
+static volatile uint32_t markTime = 0;
+
+static volatile uint32_t busy = 0;
+static volatile uint16_t errors = 0;
+static uint32_t startedAt = 0;
+
+void twiBegin(uint32_t frequency)
+{
+  // Internal pull-ups on SDA (PC4) and SCL (PC5), as Wire has them
+  PORTC |= _BV(PORTC4) | _BV(PORTC5);
+  TWSR = 0;
+  TWBR = ((F_CPU / frequency) - 16) / 2;
+  TWCR = _BV(TWEN);
+}
+
+uint8_t twiFree()
+{
+  return (tail - head - 1) & MASK;
+}
+
+bool twiIdle()
+{
+  return !active && !(TWCR & _BV(TWSTO));
+}
+
+void twiWait()
+{
+  while (!twiIdle())
+  {
+  }
+}
+
+void twiWrite(uint8_t address, const uint8_t *data, uint8_t length)
+{
+  if (length == 0)
+  {
+    return;
+  }
+  // Backpressure, the interrupt frees the room as the bytes go out
+  while (twiFree() < length + 2)
+  {
+  }
+  uint8_t at = head;
+  queue[at] = address;
+  at = (at + 1) & MASK;
+  queue[at] = length;
+  for (uint8_t i = 0; i < length; ++i)
+  {
+    at = (at + 1) & MASK;
+    queue[at] = data[i];
+  }
+  // Publish the entry only after it is complete
+  BARRIER();
+  head = (at + 1) & MASK;
+
+  // A running interrupt chain picks the entry up by itself
+  if (!active)
+  {
+    // The STOP of the previous chain has to be out first
+    while (TWCR & _BV(TWSTO))
+    {
+    }
+    active = true;
+    startedAt = micros();
+    TWCR = TWCR_NEXT | _BV(TWSTA);
+  }
+}
+
+void twiMark()
+{
+  noInterrupts();
+  markSent = false;
+  if (active)
+  {
+    markAt = head;
+    markPending = true;
+  }
+  else
+  {
+    // Nothing queued, it is all out already
+    markPending = false;
+    markSent = true;
+    markTime = micros();
+  }
+  interrupts();
+}
+
+bool twiMarkSent(uint32_t &time)
+{
+  noInterrupts();
+  bool sent = markSent;
+  markSent = false;
+  time = markTime;
+  interrupts();
+  return sent;
+}
+
+uint32_t twiBusyMicros()
+{
+  noInterrupts();
+  uint32_t value = busy;
+  interrupts();
+  return value;
+}
+
+uint16_t twiErrors()
+{
+  noInterrupts();
+  uint16_t value = errors;
+  interrupts();
+  return value;
+}
+
+// Repeated START for the next entry, or STOP
+static void next()
+{
+  if (markPending && tail == markAt)
+  {
+    markPending = false;
+    markSent = true;
+    markTime = micros();
+  }
+  if (tail != head)
+  {
+    TWCR = TWCR_NEXT | _BV(TWSTA);
+    return;
+  }
+  TWCR = _BV(TWINT) | _BV(TWEN) | _BV(TWSTO);
+  active = false;
+  busy += micros() - startedAt;
+}
+
+ISR(TWI_vect)
+{
+  uint8_t at = tail;
+  switch (TW_STATUS)
+  {
+  case TW_START:
+  case TW_REP_START:
+    TWDR = queue[at] << 1 | TW_WRITE;
+    at = (at + 1) & MASK;
+    remaining = queue[at];
+    tail = (at + 1) & MASK;
+    TWCR = TWCR_NEXT;
+    break;
+  case TW_MT_SLA_ACK:
+  case TW_MT_DATA_ACK:
+    if (remaining)
+    {
+      TWDR = queue[at];
+      tail = (at + 1) & MASK;
+      remaining--;
+      TWCR = TWCR_NEXT;
+    }
+    else
+    {
+      next();
+    }
+    break;
+  default:
+    // Not acknowledged, arbitration lost or bus error: drop the rest
+    tail = (at + remaining) & MASK;
+    remaining = 0;
+    errors++;
+    next();
+    break;
+  }
+}
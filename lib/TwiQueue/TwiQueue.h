@@ -0,0 +1,49 @@
+/*
+Interrupt-driven TWI (I2C) master transmitter.
+
+twiWrite() copies a transmission into a ring buffer and returns; the TWI
+interrupt sends the queued transmissions back to back (repeated START
+between them, STOP when the queue runs empty). The caller only waits when
+the ring has no room for the bytes (backpressure), so a frame can go out
+while the next tick's logic runs.
+
+Queue entries: address, length, data. Transmissions that are not
+acknowledged are dropped and counted.
+
+Only writes, master only. Not for use from interrupt handlers: twiWrite()
+may wait for the TWI interrupt.
+*/
+
+#ifndef TWIQUEUE_H
+#define TWIQUEUE_H
+
+#include <Arduino.h>
+
+// Ring size in bytes, power of two. A transmission takes its length + 2.
+#ifndef TWI_QUEUE_SIZE
+#define TWI_QUEUE_SIZE 128
+#endif
+#define TWI_MAX_WRITE (TWI_QUEUE_SIZE - 3)
+
+void twiBegin(uint32_t frequency);
+
+// Queue `length` (at most TWI_MAX_WRITE) bytes for the 7-bit address
+void twiWrite(uint8_t address, const uint8_t *data, uint8_t length);
+
+// Bytes that can be queued without waiting, including the entry header
+uint8_t twiFree();
+// Everything queued has been sent and the bus is released
+bool twiIdle();
+void twiWait();
+
+// Mark everything queued so far. twiMarkSent() returns true once, when the
+// last marked byte has been acknowledged, with the micros() of that moment.
+// A new mark replaces one that is not sent yet.
+void twiMark();
+bool twiMarkSent(uint32_t &time);
+
+// Statistics
+uint32_t twiBusyMicros();
+uint16_t twiErrors();
+
+#endif
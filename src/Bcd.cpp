@@ -0,0 +1,105 @@
+#include "Bcd.h"
+#include "FrameBuffer.h"
+
+#define BCD_ALL_DIRTY ((1 << BCD_DIGITS) - 1)
+
+void bcdClear(BcdCounter &counter)
+{
+  for (uint8_t i = 0; i < BCD_DIGITS / 2; ++i)
+  {
+    counter.packed[i] = 0;
+  }
+  counter.length = 1;
+  counter.dirty = BCD_ALL_DIRTY;
+}
+
+void bcdSet(BcdCounter &counter, uint16_t value)
+{
+  // Only at load time, so plain division is fine here
+  bcdClear(counter);
+  for (uint8_t digit = 0; value; ++digit)
+  {
+    uint8_t ones = value % 10;
+    value /= 10;
+    counter.packed[digit >> 1] |= (digit & 1) ? ones << 4 : ones;
+    counter.length = digit + 1;
+  }
+}
+
+void bcdIncrement(BcdCounter &counter)
+{
+  uint8_t dirty = 0;
+  for (uint8_t i = 0; i < BCD_DIGITS / 2; ++i)
+  {
+    uint8_t pair = counter.packed[i] + 1;
+    dirty |= 1 << (2 * i);
+    if ((pair & 0x0F) == 10)
+    {
+      // Carry into the tens of this byte
+      pair += 6;
+      dirty |= 2 << (2 * i);
+    }
+    if (pair < 0xA0)
+    {
+      counter.packed[i] = pair;
+      uint8_t top = (pair & 0xF0) ? 2 * i + 2 : 2 * i + 1;
+      if (top > counter.length)
+      {
+        counter.length = top;
+        // Left-aligned, every digit moves one cell
+        dirty = BCD_ALL_DIRTY;
+      }
+      counter.dirty |= dirty;
+      return;
+    }
+    // 99 wrapped to 00, carry into the next byte
+    counter.packed[i] = 0;
+  }
+  // Wrapped around completely
+  bcdClear(counter);
+}
+
+void bcdCopy(BcdCounter &to, const BcdCounter &from)
+{
+  if (to.length != from.length)
+  {
+    to.dirty = BCD_ALL_DIRTY;
+  }
+  for (uint8_t i = 0; i < BCD_DIGITS / 2; ++i)
+  {
+    uint8_t changed = to.packed[i] ^ from.packed[i];
+    if (changed & 0x0F)
+      to.dirty |= 1 << (2 * i);
+    if (changed & 0xF0)
+      to.dirty |= 2 << (2 * i);
+    to.packed[i] = from.packed[i];
+  }
+  to.length = from.length;
+}
+
+int8_t bcdCompare(const BcdCounter &a, const BcdCounter &b)
+{
+  // Packed BCD orders like binary, most significant byte first
+  for (uint8_t i = BCD_DIGITS / 2; i-- > 0;)
+  {
+    if (a.packed[i] != b.packed[i])
+    {
+      return a.packed[i] < b.packed[i] ? -1 : 1;
+    }
+  }
+  return 0;
+}
+
+void bcdDraw(BcdCounter &counter, uint8_t col, uint8_t row, bool all)
+{
+  uint8_t dirty = all ? BCD_ALL_DIRTY : counter.dirty;
+  for (uint8_t digit = 0; digit < counter.length; ++digit)
+  {
+    if (dirty & (1 << digit))
+    {
+      fb.setCursor(col + counter.length - 1 - digit, row);
+      fb.write('0' + bcdDigit(counter, digit));
+    }
+  }
+  counter.dirty = 0;
+}
@@ -0,0 +1,151 @@
+#include "FrameBuffer.h"
+#include "Hal.h"
+#include "Latency.h"
+#include "Telemetry.h"
+
+FrameBuffer fb;
+
+FrameBuffer::FrameBuffer()
+    : cursorCol(0), cursorRow(0), lastBytes(0), total(0), flushes(0)
+{
+  clear();
+  // The display is blank after halDisplayInit()
+  for (uint8_t row = 0; row < FB_ROWS; ++row)
+  {
+    for (uint8_t col = 0; col < FB_COLS; ++col)
+    {
+      shown[row][col] = ' ';
+    }
+  }
+}
+
+void FrameBuffer::clear()
+{
+  for (uint8_t row = 0; row < FB_ROWS; ++row)
+  {
+    for (uint8_t col = 0; col < FB_COLS; ++col)
+    {
+      cells[row][col] = ' ';
+    }
+  }
+  cursorCol = 0;
+  cursorRow = 0;
+}
+
+void FrameBuffer::setCursor(uint8_t col, uint8_t row)
+{
+  cursorCol = col;
+  cursorRow = row;
+}
+
+void FrameBuffer::write(uint8_t c)
+{
+  // Text running past the right edge is clipped
+  if (cursorRow < FB_ROWS && cursorCol < FB_COLS)
+  {
+    cells[cursorRow][cursorCol] = c;
+  }
+  cursorCol++;
+}
+
+void FrameBuffer::print(const char *text)
+{
+  while (*text)
+  {
+    write(*text++);
+  }
+}
+
+void FrameBuffer::print(const __FlashStringHelper *text)
+{
+  const char *p = reinterpret_cast<const char *>(text);
+  uint8_t c;
+  while ((c = pgm_read_byte(p++)))
+  {
+    write(c);
+  }
+}
+
+void FrameBuffer::print(unsigned int value)
+{
+  char digits[5];
+  uint8_t n = 0;
+  do
+  {
+    digits[n++] = '0' + value % 10;
+    value /= 10;
+  } while (value);
+  while (n)
+  {
+    write(digits[--n]);
+  }
+}
+
+void FrameBuffer::print(int value)
+{
+  if (value < 0)
+  {
+    write('-');
+    value = -value;
+  }
+  print((unsigned int)value);
+}
+
+void FrameBuffer::invalidate()
+{
+  for (uint8_t row = 0; row < FB_ROWS; ++row)
+  {
+    for (uint8_t col = 0; col < FB_COLS; ++col)
+    {
+      // Never a valid cell value, so every cell compares dirty
+      shown[row][col] = cells[row][col] ^ 0xFF;
+    }
+  }
+}
+
+uint16_t FrameBuffer::flush()
+{
+  uint16_t flushStart = telemetryTime();
+  uint16_t bytes = 0;
+  for (uint8_t row = 0; row < FB_ROWS; ++row)
+  {
+    uint8_t col = 0;
+    while (col < FB_COLS)
+    {
+#ifdef FB_FULL_REFRESH
+      // Reference mode: behave like the old full redraw
+      bool dirty = true;
+#else
+      bool dirty = cells[row][col] != shown[row][col];
+#endif
+      if (!dirty)
+      {
+        col++;
+        continue;
+      }
+      // One cursor command, then the whole run of changed cells
+      uint8_t runStart = col;
+#ifdef FB_FULL_REFRESH
+      while (col < FB_COLS)
+#else
+      while (col < FB_COLS && cells[row][col] != shown[row][col])
+#endif
+      {
+        shown[row][col] = cells[row][col];
+        col++;
+      }
+      halDisplaySetCursor(runStart, row);
+      halDisplayWrite(&cells[row][runStart], col - runStart);
+      bytes += 1 + col - runStart;
+    }
+  }
+  lastBytes = bytes;
+  total += bytes;
+  flushes++;
+  if (bytes)
+  {
+    telemetryFlush(flushStart, bytes);
+    latencyFlush(bytes);
+  }
+  return bytes;
+}
@@ -0,0 +1,60 @@
+#include "FrameScheduler.h"
+#include "Hal.h"
+
+FrameScheduler::FrameScheduler()
+    : periodUs(0), nextTick(0), renderPending(false), lateTicks(0),
+      overrunCount(0), skippedCount(0), droppedCount(0)
+{
+}
+
+void FrameScheduler::start(uint16_t periodMs)
+{
+  periodUs = (uint32_t)periodMs * 1000;
+  nextTick = halMicros();
+  renderPending = false;
+  lateTicks = 0;
+  overrunCount = 0;
+  skippedCount = 0;
+  droppedCount = 0;
+}
+
+void FrameScheduler::setPeriod(uint16_t periodMs)
+{
+  uint32_t newPeriod = (uint32_t)periodMs * 1000;
+  nextTick += newPeriod - periodUs;
+  periodUs = newPeriod;
+}
+
+uint8_t FrameScheduler::update()
+{
+  uint32_t now = halMicros();
+  renderPending = false;
+  // Signed difference keeps this right across the micros() wrap
+  int32_t behind = (int32_t)(now - nextTick);
+  if (behind < 0)
+  {
+    return 0;
+  }
+
+  uint32_t due = periodUs ? 1 + behind / periodUs : 1;
+  if (due > SCHEDULER_MAX_CATCH_UP)
+  {
+    // Too far behind to catch up without a visible jump, drop the rest
+    droppedCount += due - SCHEDULER_MAX_CATCH_UP;
+    due = SCHEDULER_MAX_CATCH_UP;
+    nextTick = now + periodUs;
+  }
+  else
+  {
+    nextTick += due * periodUs;
+  }
+
+  lateTicks = due - 1;
+  if (lateTicks)
+  {
+    overrunCount++;
+    skippedCount += lateTicks;
+  }
+  renderPending = true;
+  return due;
+}
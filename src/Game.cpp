@@ -0,0 +1,131 @@
+#include "Game.h"
+#include "FrameBuffer.h"
+#include "Hal.h"
+#include "Quiz.h"
+#include "Telemetry.h"
+
+// The menu lists the games in this order
+static const GameModule *const modules[] = {
+    &rbrModule,
+#if QUIZ_FITS_DISPLAY
+    &quizModule,
+#endif
+    &infoModule,
+};
+
+#define GAME_MODULES (sizeof(modules) / sizeof(modules[0]))
+static_assert(GAME_MODULES <= GAME_MAX_MODULES, "one menu button per game");
+
+static const GameModule *game = 0;
+// Buttons pressed since the last tick, in order
+static uint8_t events[GAME_MAX_EVENTS];
+static uint8_t eventCount = 0;
+static uint32_t lastTick = 0;
+static bool drawPending = false;
+static uint8_t droppedInRow = 0;
+static uint16_t dropped = 0;
+static uint8_t lateTicks = 0;
+
+uint8_t gameCount()
+{
+  return GAME_MODULES;
+}
+
+const GameModule *gameModule(uint8_t index)
+{
+  return modules[index];
+}
+
+static void render()
+{
+  game->render();
+  drawPending = false;
+  droppedInRow = 0;
+  fb.flush();
+#ifdef FB_STATS
+  halSerialPrint(fb.lastFlushBytes());
+  halSerialPrint(" ");
+  halSerialPrint(halDisplayCharsPerMs());
+  halSerialPrint(" ");
+  halSerialPrint(lateTicks);
+  halSerialPrint("\n");
+#endif
+  lateTicks = 0;
+}
+
+void gameStart(const GameModule *module)
+{
+  game = module;
+  eventCount = 0;
+  dropped = 0;
+  lateTicks = 0;
+  game->init();
+  lastTick = halMillis();
+  // The loop flushes it, together with the first tick's frame
+  game->render();
+  drawPending = false;
+  droppedInRow = 0;
+}
+
+void gameEvent(uint8_t button)
+{
+  if (eventCount < GAME_MAX_EVENTS)
+  {
+    events[eventCount++] = button;
+  }
+}
+
+uint8_t gameUpdate()
+{
+  uint32_t now = halMillis();
+  uint16_t dt = now - lastTick;
+  lastTick = now;
+  uint8_t count = eventCount;
+  eventCount = 0;
+
+  uint32_t start = halMicros();
+  uint8_t result = game->tick(dt, events, count);
+  uint32_t spent = halMicros() - start;
+  if (result & GAME_EXIT)
+  {
+    return GAME_EXIT;
+  }
+
+  drawPending |= result & GAME_DRAW;
+  uint16_t budget = game->budgetUs ? game->budgetUs : GAME_BUDGET_US;
+  if (drawPending)
+  {
+    // A slow tick gives the loop back instead of rendering as well, the
+    // next tick renders the newer state
+    if (spent > budget && (result & GAME_ANIMATE) && droppedInRow < GAME_MAX_DROPPED)
+    {
+      droppedInRow++;
+      dropped++;
+    }
+    else
+    {
+      render();
+    }
+  }
+  return result & GAME_ANIMATE;
+}
+
+void gameStop()
+{
+  if (game->exit)
+  {
+    game->exit();
+  }
+  game = 0;
+}
+
+void gameLate(uint8_t ticks)
+{
+  lateTicks += ticks;
+  telemetryLate(ticks);
+}
+
+uint16_t gameDroppedRenders()
+{
+  return dropped;
+}
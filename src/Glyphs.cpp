@@ -0,0 +1,97 @@
+#include "Glyphs.h"
+#include "Hal.h"
+
+static const uint8_t glyphs[GLYPH_COUNT][8] PROGMEM = {
+    // Run position 1
+    {0b01100, 0b01100, 0b00000, 0b01110, 0b11100, 0b01100, 0b11010, 0b10011},
+    // Run position 2
+    {0b01100, 0b01100, 0b00000, 0b01100, 0b01100, 0b01100, 0b01100, 0b01110},
+    // Jump
+    {0b01100, 0b01100, 0b00000, 0b11110, 0b01101, 0b11111, 0b10000, 0b00000},
+    // Jump lower
+    {0b11110, 0b01101, 0b11111, 0b10000, 0b00000, 0b00000, 0b00000, 0b00000},
+    // Ground
+    {0b11111, 0b11111, 0b11111, 0b11111, 0b11111, 0b11111, 0b11111, 0b11111},
+    // Ground right
+    {0b00011, 0b00011, 0b00011, 0b00011, 0b00011, 0b00011, 0b00011, 0b00011},
+    // Ground left
+    {0b11000, 0b11000, 0b11000, 0b11000, 0b11000, 0b11000, 0b11000, 0b11000},
+};
+
+// CGRAM is undefined after power-on
+static uint8_t slotGlyph[GLYPH_SLOTS] = {GLYPH_NONE, GLYPH_NONE, GLYPH_NONE, GLYPH_NONE,
+                                         GLYPH_NONE, GLYPH_NONE, GLYPH_NONE, GLYPH_NONE};
+static uint8_t refs[GLYPH_SLOTS];
+// Slots from least to most recently used
+static uint8_t order[GLYPH_SLOTS] = {1, 2, 3, 4, 5, 6, 7, 0};
+static uint16_t uploads = 0;
+
+static void touch(uint8_t slot)
+{
+  uint8_t i = 0;
+  while (order[i] != slot)
+  {
+    i++;
+  }
+  for (; i < GLYPH_SLOTS - 1; ++i)
+  {
+    order[i] = order[i + 1];
+  }
+  order[GLYPH_SLOTS - 1] = slot;
+}
+
+static void upload(uint8_t slot, uint8_t glyph)
+{
+  uint8_t bitmap[8];
+  for (uint8_t row = 0; row < 8; ++row)
+  {
+    bitmap[row] = pgm_read_byte(&glyphs[glyph][row]);
+  }
+  halDisplayCreateChar(slot, bitmap);
+  slotGlyph[slot] = glyph;
+  uploads++;
+}
+
+uint8_t glyphAcquire(uint8_t glyph)
+{
+  uint8_t slot = 0;
+  while (slot < GLYPH_SLOTS && slotGlyph[slot] != glyph)
+  {
+    slot++;
+  }
+  if (slot == GLYPH_SLOTS)
+  {
+    // Not in CGRAM, take the least recently used free slot
+    uint8_t i = 0;
+    while (i < GLYPH_SLOTS && refs[order[i]])
+    {
+      i++;
+    }
+    if (i == GLYPH_SLOTS)
+    {
+      return GLYPH_NONE;
+    }
+    slot = order[i];
+    upload(slot, glyph);
+  }
+  refs[slot]++;
+  touch(slot);
+  return slot;
+}
+
+void glyphRelease(uint8_t glyph)
+{
+  for (uint8_t slot = 0; slot < GLYPH_SLOTS; ++slot)
+  {
+    if (slotGlyph[slot] == glyph && refs[slot])
+    {
+      refs[slot]--;
+      return;
+    }
+  }
+}
+
+uint16_t glyphUploads()
+{
+  return uploads;
+}
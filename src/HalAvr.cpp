@@ -0,0 +1,301 @@
+#ifdef ARDUINO
+
+#include "Hal.h"
+#include "Geometry.h"
+#include <LcdI2C.h>
+#include <avr/eeprom.h>
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+
+static LcdI2C lcd(0x27, Display::cols, Display::rows);
+
+// Set by every button interrupt, cleared by halSleep
+static volatile bool wakePending = false;
+static volatile bool ledOn = false;
+static void (*buttonsChanged)() = 0;
+
+// EEPROM writes, head is only written by the main loop, tail only by the
+// interrupt
+static uint16_t eepromAddress[HAL_EEPROM_QUEUE];
+static uint8_t eepromValue[HAL_EEPROM_QUEUE];
+static volatile uint8_t eepromHead = 0;
+static volatile uint8_t eepromTail = 0;
+
+// All four buttons sit on PORTD (PCINT18..21). Unlike INT0/INT1 edge
+// interrupts a pin change also wakes the MCU from power-down.
+ISR(PCINT2_vect)
+{
+  wakePending = true;
+  if (buttonsChanged)
+  {
+    buttonsChanged();
+  }
+}
+
+// Fires whenever the EEPROM can take the next byte
+ISR(EE_READY_vect)
+{
+  uint8_t slot = eepromTail;
+  while (slot != eepromHead)
+  {
+    EEAR = eepromAddress[slot];
+    uint8_t value = eepromValue[slot];
+    slot = (slot + 1) & (HAL_EEPROM_QUEUE - 1);
+    // Unchanged bytes cost neither time nor wear
+    EECR |= _BV(EERE);
+    if (EEDR != value)
+    {
+      EEDR = value;
+      // Interrupts are off here, so EEPE follows EEMPE within 4 cycles
+      EECR |= _BV(EEMPE);
+      EECR |= _BV(EEPE);
+      eepromTail = slot;
+      return;
+    }
+  }
+  eepromTail = slot;
+  EECR &= ~_BV(EERIE);
+}
+
+uint32_t halMillis()
+{
+  return millis();
+}
+
+uint32_t halMicros()
+{
+  return micros();
+}
+
+void halDelay(uint32_t ms)
+{
+  delay(ms);
+}
+
+void halButtonsInit(void (*changed)())
+{
+  PinYellow::inputPullup();
+  PinGreen::inputPullup();
+  PinBlue::inputPullup();
+  // Red is the LED too, it starts high: LED off
+  PinRed::high();
+  PinRed::output();
+
+  buttonsChanged = changed;
+  // PCINT16..23 are PD0..7
+  PCMSK2 |= PinButtons::mask;
+  PCIFR = _BV(PCIF2);
+  PCICR |= _BV(PCIE2);
+}
+
+void halButtonsLock()
+{
+  PCICR &= ~_BV(PCIE2);
+}
+
+void halButtonsUnlock()
+{
+  // An edge in between is still flagged and fires now
+  PCICR |= _BV(PCIE2);
+}
+
+uint8_t halButtonLevels()
+{
+  uint8_t levels = PinButtons::read() ^ PinButtons::mask;
+  // The lit LED pulls the Red pin low, that is not a press
+  if (ledOn)
+  {
+    levels &= ~PinRed::mask;
+  }
+  return levels;
+}
+
+void halLed(bool on)
+{
+  // ledOn has to cover every moment the pin is low: set it before the pin
+  // goes low, clear it only after the pin is high again
+  if (on)
+  {
+    ledOn = true;
+    PinRed::low();
+  }
+  else
+  {
+    PinRed::high();
+    ledOn = false;
+  }
+}
+
+void halSleep(uint8_t mode)
+{
+  uint8_t adc = ADCSRA;
+  if (mode == HAL_SLEEP_POWER_DOWN)
+  {
+    // The ADC would keep drawing current in power-down, and the TWI would
+    // stop halfway through what is queued for the display
+    ADCSRA &= ~_BV(ADEN);
+    lcd.wait();
+    set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+  }
+  else
+  {
+    set_sleep_mode(SLEEP_MODE_IDLE);
+  }
+
+  cli();
+  if (!wakePending)
+  {
+    sleep_enable();
+    if (mode == HAL_SLEEP_POWER_DOWN)
+    {
+      sleep_bod_disable();
+    }
+    // sei() takes effect after the next instruction, so no interrupt can
+    // slip in between the check and going to sleep
+    sei();
+    sleep_cpu();
+    sleep_disable();
+  }
+  wakePending = false;
+  sei();
+  ADCSRA = adc;
+}
+
+void halDisplayInit()
+{
+  lcd.init();
+}
+
+void halDisplayBacklight(bool on)
+{
+  if (on)
+    lcd.backlight();
+  else
+    lcd.noBacklight();
+}
+
+void halDisplayPower(bool on)
+{
+  if (on)
+    lcd.display();
+  else
+    lcd.noDisplay();
+}
+
+void halDisplayCreateChar(uint8_t location, const uint8_t bitmap[])
+{
+  lcd.createChar(location, bitmap);
+}
+
+void halDisplaySetCursor(uint8_t col, uint8_t row)
+{
+  lcd.setAddress(Display::address(col, row));
+}
+
+void halDisplayWrite(const uint8_t *data, uint8_t length)
+{
+  lcd.write(data, length);
+}
+
+uint16_t halDisplayCharsPerMs()
+{
+  return lcd.charsPerMs();
+}
+
+void halDisplayMark()
+{
+  lcd.mark();
+}
+
+bool halDisplayMarkSent(uint32_t &time)
+{
+  return lcd.markSent(time);
+}
+
+uint8_t halEepromRead(uint16_t address)
+{
+  // A queued write may be for this very byte
+  while (!halEepromIdle())
+  {
+  }
+  return eeprom_read_byte((const uint8_t *)address);
+}
+
+void halEepromWrite(uint16_t address, uint8_t value)
+{
+  uint8_t head = eepromHead;
+  uint8_t next = (head + 1) & (HAL_EEPROM_QUEUE - 1);
+  while (next == eepromTail)
+  {
+    // Full, wait for the interrupt to take a byte
+  }
+  eepromAddress[head] = address;
+  eepromValue[head] = value;
+  eepromHead = next;
+  EECR |= _BV(EERIE);
+}
+
+bool halEepromIdle()
+{
+  return eepromHead == eepromTail && !(EECR & _BV(EEPE));
+}
+
+uint32_t halEntropy()
+{
+  uint8_t admux = ADMUX;
+  uint8_t adcsra = ADCSRA;
+  // Temperature sensor against the 1.1 V reference, right after switching
+  // the reference; only the jitter in the low bits is used
+  ADMUX = _BV(REFS1) | _BV(REFS0) | _BV(MUX3);
+  ADCSRA = _BV(ADEN) | _BV(ADPS2) | _BV(ADPS1) | _BV(ADPS0);
+  uint32_t noise = 0;
+  for (uint8_t i = 0; i < 64; ++i)
+  {
+    ADCSRA |= _BV(ADSC);
+    while (ADCSRA & _BV(ADSC))
+    {
+    }
+    // ADCL has to be read before ADCH
+    uint8_t low = ADCL;
+    (void)ADCH;
+    noise = ((noise << 3) | (noise >> 29)) ^ low;
+  }
+  ADMUX = admux;
+  ADCSRA = adcsra;
+  return noise ^ micros();
+}
+
+void halTimerBegin()
+{
+  // Normal mode, clk/64: 4 us per count. Pins 9 and 10 lose their PWM.
+  TCCR1A = 0;
+  TCCR1B = _BV(CS11) | _BV(CS10);
+  TCCR1C = 0;
+}
+
+uint16_t halTimer()
+{
+  return TCNT1;
+}
+
+void halSerialBegin(uint32_t baud)
+{
+  Serial.begin(baud);
+}
+
+void halSerialPrint(const char *text)
+{
+  Serial.print(text);
+}
+
+void halSerialPrint(uint32_t value)
+{
+  Serial.print(value);
+}
+
+void halSerialWrite(const uint8_t *data, uint8_t length)
+{
+  Serial.write(data, length);
+}
+
+#endif
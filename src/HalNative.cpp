@@ -0,0 +1,457 @@
+#ifndef ARDUINO
+
+/*
+Host implementation of the HAL.
+
+Time is virtual: delays return immediately and advance the clock, so a
+session runs at full host speed. Button input comes from a script file,
+one event per line:
+
+    # time_ms button action
+    500 yellow press
+    600 yellow release
+
+The mock LCD keeps a copy of the DDRAM of the build's panel (Geometry.h) and
+records a frame every time the picture changed before the clock moved on.
+
+The EEPROM can be kept in an image file (-e), which is read at start and
+written back at the end. -r plays the RBR run recorded in it instead of
+starting the console.
+
+Usage: program [-s script] [-t stop_ms] [-q] [-e eeprom.bin] [-r]
+*/
+
+#include "Hal.h"
+#include "Geometry.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+void setup();
+void loop();
+bool replayRun();
+
+#define MOCK_COLS Display::cols
+#define MOCK_ROWS Display::rows
+
+// Host cost of one clock read
+#define CLOCK_COST_US 4
+
+struct ScriptEvent
+{
+  uint32_t ms;
+  uint8_t pin;
+  bool press;
+};
+
+struct Frame
+{
+  uint32_t ms;
+  bool backlight;
+  bool display;
+  uint8_t cells[MOCK_ROWS][MOCK_COLS];
+};
+
+// The registers of Pin.h, released buttons read high through their pull-ups
+PinMockPort pinPortB = {0xFF, 0, 0};
+PinMockPort pinPortC = {0xFF, 0, 0};
+PinMockPort pinPortD = {0xFF, 0, 0};
+
+static uint64_t nowUs = 0;
+static uint32_t stopMs = 60000;
+static bool quiet = false;
+
+static std::vector<ScriptEvent> script;
+static size_t nextEvent = 0;
+static bool wakePending = false;
+static void (*buttonsChanged)() = 0;
+static bool inInterrupt = false;
+
+static uint8_t ddram[MOCK_ROWS][MOCK_COLS];
+static uint8_t cgram[8][8];
+static uint8_t cursorCol = 0;
+static uint8_t cursorRow = 0;
+static bool backlightOn = true;
+static bool displayOn = true;
+static bool displayDirty = false;
+static uint32_t charsWritten = 0;
+static bool markPending = false;
+static uint64_t markUs = 0;
+static std::vector<Frame> frames;
+
+static uint8_t eeprom[HAL_EEPROM_SIZE];
+static const char *eepromPath = 0;
+
+static void printFrame(const Frame &frame)
+{
+  printf("t=%u ms%s%s\n", frame.ms, frame.backlight ? "" : " (backlight off)", frame.display ? "" : " (display off)");
+  for (uint8_t row = 0; row < MOCK_ROWS; ++row)
+  {
+    putchar('|');
+    for (uint8_t col = 0; col < MOCK_COLS; ++col)
+    {
+      uint8_t c = frame.cells[row][col];
+      // CGRAM glyphs are shown as circled digits
+      if (c == 0)
+        printf("\xe2\x93\xaa");
+      else if (c < 8)
+        printf("\xe2\x91%c", 0x9f + c);
+      else
+        putchar(c);
+    }
+    printf("|\n");
+  }
+}
+
+static void recordFrame()
+{
+  Frame frame;
+  frame.ms = nowUs / 1000;
+  frame.backlight = backlightOn;
+  frame.display = displayOn;
+  memcpy(frame.cells, ddram, sizeof(ddram));
+  frames.push_back(frame);
+  displayDirty = false;
+}
+
+#ifndef PIO_UNIT_TESTING
+static void loadEeprom()
+{
+  // Erased EEPROM reads as 0xFF
+  memset(eeprom, 0xFF, sizeof(eeprom));
+  FILE *file = eepromPath ? fopen(eepromPath, "rb") : 0;
+  if (file)
+  {
+    if (fread(eeprom, 1, sizeof(eeprom), file) != sizeof(eeprom))
+      fprintf(stderr, "%s: short EEPROM image\n", eepromPath);
+    fclose(file);
+  }
+}
+#endif
+
+static void saveEeprom()
+{
+  FILE *file = eepromPath ? fopen(eepromPath, "wb") : 0;
+  if (file)
+  {
+    fwrite(eeprom, 1, sizeof(eeprom), file);
+    fclose(file);
+  }
+}
+
+static void finish(int status = 0)
+{
+  if (displayDirty)
+  {
+    recordFrame();
+  }
+  if (!quiet)
+  {
+    for (size_t i = 0; i < frames.size(); ++i)
+    {
+      printFrame(frames[i]);
+    }
+  }
+  printf("frames: %u, chars written: %u, simulated: %u ms\n",
+         (unsigned)frames.size(), charsWritten, (unsigned)(nowUs / 1000));
+  saveEeprom();
+  exit(status);
+}
+
+static void advance(uint32_t us)
+{
+  // The picture that was on screen up to now is one frame
+  if (displayDirty)
+  {
+    recordFrame();
+  }
+  nowUs += us;
+  while (nextEvent < script.size() && script[nextEvent].ms <= nowUs / 1000)
+  {
+    const ScriptEvent &event = script[nextEvent++];
+    // Pressed buttons pull their pin low
+    if (event.press)
+      pinPortD.in &= ~(1 << event.pin);
+    else
+      pinPortD.in |= 1 << event.pin;
+    wakePending = true;
+    if (buttonsChanged)
+    {
+      // The clock stands still while the "interrupt" runs
+      inInterrupt = true;
+      buttonsChanged();
+      inInterrupt = false;
+    }
+  }
+  if (nowUs / 1000 >= stopMs)
+  {
+    finish();
+  }
+}
+
+#ifndef PIO_UNIT_TESTING
+static uint8_t buttonPin(const char *name)
+{
+  if (strcmp(name, "yellow") == 0)
+    return ButtonYellow;
+  if (strcmp(name, "green") == 0)
+    return ButtonGreen;
+  if (strcmp(name, "red") == 0)
+    return ButtonRed;
+  if (strcmp(name, "blue") == 0)
+    return ButtonBlue;
+  return 0;
+}
+
+static void loadScript(const char *path)
+{
+  FILE *file = fopen(path, "r");
+  if (!file)
+  {
+    fprintf(stderr, "cannot open script %s\n", path);
+    exit(1);
+  }
+  char line[128];
+  unsigned lineNumber = 0;
+  while (fgets(line, sizeof(line), file))
+  {
+    lineNumber++;
+    char button[16], action[16];
+    unsigned ms;
+    if (line[0] == '#' || line[0] == '\n')
+      continue;
+    if (sscanf(line, "%u %15s %15s", &ms, button, action) != 3 || !buttonPin(button))
+    {
+      fprintf(stderr, "%s:%u: expected \"<ms> <yellow|green|red|blue> <press|release>\"\n", path, lineNumber);
+      exit(1);
+    }
+    ScriptEvent event = {ms, buttonPin(button), strcmp(action, "press") == 0};
+    script.push_back(event);
+  }
+  fclose(file);
+  std::stable_sort(script.begin(), script.end(),
+                   [](const ScriptEvent &a, const ScriptEvent &b) { return a.ms < b.ms; });
+}
+
+#endif
+
+uint32_t halMillis()
+{
+  if (!inInterrupt)
+    advance(CLOCK_COST_US);
+  return nowUs / 1000;
+}
+
+uint32_t halMicros()
+{
+  if (!inInterrupt)
+    advance(CLOCK_COST_US);
+  return (uint32_t)nowUs;
+}
+
+void halDelay(uint32_t ms)
+{
+  advance(ms * 1000);
+}
+
+void halButtonsInit(void (*changed)())
+{
+  buttonsChanged = changed;
+}
+
+void halButtonsLock()
+{
+}
+
+void halButtonsUnlock()
+{
+}
+
+uint8_t halButtonLevels()
+{
+  return PinButtons::read() ^ PinButtons::mask;
+}
+
+void halLed(bool)
+{
+}
+
+void halSleep(uint8_t mode)
+{
+  if (wakePending)
+  {
+    wakePending = false;
+    return;
+  }
+  if (mode == HAL_SLEEP_IDLE)
+  {
+    // Timer 0 overflows about once per millisecond
+    advance(1000 - nowUs % 1000);
+  }
+  else
+  {
+    // Only the next button edge wakes the MCU up
+    if (nextEvent == script.size())
+      finish();
+    uint64_t eventUs = (uint64_t)script[nextEvent].ms * 1000;
+    advance(eventUs > nowUs ? eventUs - nowUs : 0);
+  }
+  wakePending = false;
+}
+
+void halDisplayInit()
+{
+  memset(ddram, ' ', sizeof(ddram));
+}
+
+void halDisplayBacklight(bool on)
+{
+  displayDirty |= backlightOn != on;
+  backlightOn = on;
+}
+
+void halDisplayPower(bool on)
+{
+  displayDirty |= displayOn != on;
+  displayOn = on;
+}
+
+void halDisplayCreateChar(uint8_t location, const uint8_t bitmap[])
+{
+  memcpy(cgram[location & 7], bitmap, 8);
+}
+
+void halDisplaySetCursor(uint8_t col, uint8_t row)
+{
+  cursorCol = col;
+  cursorRow = row;
+}
+
+void halDisplayWrite(const uint8_t *data, uint8_t length)
+{
+  for (uint8_t i = 0; i < length; ++i)
+  {
+    if (cursorRow < MOCK_ROWS && cursorCol < MOCK_COLS)
+    {
+      ddram[cursorRow][cursorCol] = data[i];
+    }
+    cursorCol++;
+  }
+  charsWritten += length;
+  displayDirty = true;
+}
+
+uint16_t halDisplayCharsPerMs()
+{
+  return 0;
+}
+
+// Writes are done at once, the mark is sent when it is set
+void halDisplayMark()
+{
+  markPending = true;
+  markUs = nowUs;
+}
+
+bool halDisplayMarkSent(uint32_t &time)
+{
+  if (!markPending)
+    return false;
+  markPending = false;
+  time = (uint32_t)markUs;
+  return true;
+}
+
+uint8_t halEepromRead(uint16_t address)
+{
+  return eeprom[address % HAL_EEPROM_SIZE];
+}
+
+// Written at once, the host does not wait for the cells
+void halEepromWrite(uint16_t address, uint8_t value)
+{
+  eeprom[address % HAL_EEPROM_SIZE] = value;
+}
+
+bool halEepromIdle()
+{
+  return true;
+}
+
+uint32_t halEntropy()
+{
+  return 0;
+}
+
+// Follows the virtual clock without advancing it
+void halTimerBegin()
+{
+}
+
+uint16_t halTimer()
+{
+  return nowUs / HAL_TIMER_US;
+}
+
+void halSerialBegin(uint32_t)
+{
+}
+
+void halSerialPrint(const char *text)
+{
+  fputs(text, stderr);
+}
+
+void halSerialPrint(uint32_t value)
+{
+  fprintf(stderr, "%u", value);
+}
+
+void halSerialWrite(const uint8_t *data, uint8_t length)
+{
+  fwrite(data, 1, length, stderr);
+}
+
+// The unit tests (test/, pio test -e native) bring their own main()
+#ifndef PIO_UNIT_TESTING
+int main(int argc, char **argv)
+{
+  bool replay = false;
+  for (int i = 1; i < argc; ++i)
+  {
+    if (strcmp(argv[i], "-s") == 0 && i + 1 < argc)
+      loadScript(argv[++i]);
+    else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc)
+      stopMs = atol(argv[++i]);
+    else if (strcmp(argv[i], "-q") == 0)
+      quiet = true;
+    else if (strcmp(argv[i], "-e") == 0 && i + 1 < argc)
+      eepromPath = argv[++i];
+    else if (strcmp(argv[i], "-r") == 0)
+      replay = true;
+    else
+    {
+      fprintf(stderr, "usage: %s [-s script] [-t stop_ms] [-q] [-e eeprom.bin] [-r]\n", argv[0]);
+      return 1;
+    }
+  }
+  loadEeprom();
+  if (replay)
+  {
+    halDisplayInit();
+    // No stop time, the run ends by itself
+    stopMs = UINT32_MAX;
+    finish(replayRun() ? 0 : 1);
+  }
+  setup();
+  for (;;)
+  {
+    loop();
+  }
+}
+
+#endif
+
+#endif
@@ -0,0 +1,35 @@
+#include "Game.h"
+#include "FrameBuffer.h"
+#include "Hal.h"
+
+static const char name[] PROGMEM = "Info";
+static_assert(sizeof(name) - 1 <= GAME_NAME_LENGTH, "menu entry too long");
+
+static void infoInit()
+{
+}
+
+// Nothing moves, the screen is drawn once
+static uint8_t infoTick(uint16_t dt, const uint8_t *events, uint8_t count)
+{
+  (void)dt;
+  (void)events;
+  (void)count;
+  return 0;
+}
+
+static void infoRender()
+{
+  fb.clear();
+#if DISPLAY_ROWS >= 4
+  FB_TEXT(1, 0, "Check my GitHub :)");
+  FB_TEXT(4, 1, "Name: mechasB");
+  FB_TEXT(4, 2, "Repositories:");
+  FB_TEXT(3, 3, "G a m e  B o y");
+#else
+  FB_TEXT(0, 0, "GitHub: mechasB");
+  FB_TEXT(0, 1, "Repo: GameBoy");
+#endif
+}
+
+const GameModule infoModule = {name, 0, infoInit, infoTick, infoRender, 0};
@@ -0,0 +1,134 @@
+#include "Input.h"
+#include "Hal.h"
+
+#define INPUT_BUTTONS 4
+
+// Keeps the compiler from moving slot accesses across the index updates
+#define BARRIER() __asm__ __volatile__("" ::: "memory")
+
+static const uint8_t buttons[INPUT_BUTTONS] = {ButtonYellow, ButtonRed, ButtonGreen, ButtonBlue};
+
+static InputEvent queue[INPUT_QUEUE_SIZE];
+// head is only written by the interrupt (or by inputUpdate() while it is
+// locked out), tail only by the main loop
+static volatile uint8_t head = 0;
+static volatile uint8_t tail = 0;
+static volatile uint8_t dropped = 0;
+static uint32_t maxDelay = 0;
+
+// Debounced state, only touched by the interrupt
+static uint8_t accepted = 0;
+static uint32_t lastEdge[INPUT_BUTTONS];
+// Bit i: an edge of buttons[i] was dropped as bounce, its pin is read
+// again after the window
+static volatile uint8_t settling = 0;
+
+static void push(uint8_t button, bool pressed, uint32_t time)
+{
+  uint8_t next = (head + 1) & (INPUT_QUEUE_SIZE - 1);
+  if (next == tail)
+  {
+    dropped++;
+    return;
+  }
+  queue[head].button = button;
+  queue[head].pressed = pressed;
+  queue[head].time = time;
+  // Publish the slot only after it is complete
+  BARRIER();
+  head = next;
+}
+
+// Pin-change interrupt
+static void buttonsChanged()
+{
+  uint32_t now = halMicros();
+  uint8_t levels = halButtonLevels();
+  uint8_t changed = levels ^ accepted;
+  for (uint8_t i = 0; i < INPUT_BUTTONS; ++i)
+  {
+    uint8_t mask = 1 << buttons[i];
+    if (!(changed & mask))
+    {
+      continue;
+    }
+    if (now - lastEdge[i] < INPUT_DEBOUNCE_US)
+    {
+      settling |= 1 << i;
+      continue;
+    }
+    lastEdge[i] = now;
+    accepted ^= mask;
+    push(buttons[i], levels & mask, now);
+  }
+}
+
+void inputBegin()
+{
+  uint32_t now = halMicros();
+  for (uint8_t i = 0; i < INPUT_BUTTONS; ++i)
+  {
+    lastEdge[i] = now - INPUT_DEBOUNCE_US;
+  }
+  halButtonsInit(buttonsChanged);
+  accepted = halButtonLevels();
+}
+
+bool inputPop(InputEvent &event)
+{
+  uint8_t slot = tail;
+  if (slot == head)
+  {
+    return false;
+  }
+  BARRIER();
+  event = queue[slot];
+  BARRIER();
+  tail = (slot + 1) & (INPUT_QUEUE_SIZE - 1);
+  uint32_t delay = halMicros() - event.time;
+  if (delay > maxDelay)
+  {
+    maxDelay = delay;
+  }
+  return true;
+}
+
+bool inputUpdate()
+{
+  if (!settling)
+  {
+    return false;
+  }
+  // The interrupt handler runs here as if a pin had changed, so nothing
+  // else may touch the debounce state meanwhile
+  halButtonsLock();
+  uint32_t now = halMicros();
+  uint8_t settled = 0;
+  for (uint8_t i = 0; i < INPUT_BUTTONS; ++i)
+  {
+    if ((settling & (1 << i)) && now - lastEdge[i] >= INPUT_DEBOUNCE_US)
+    {
+      settled |= 1 << i;
+    }
+  }
+  if (settled)
+  {
+    // A bounce that settled on the other level within the window
+    // pushes its edge now
+    settling &= ~settled;
+    buttonsChanged();
+  }
+  bool pending = settling;
+  halButtonsUnlock();
+  return pending;
+}
+
+uint8_t inputDropped()
+{
+  return dropped;
+}
+
+uint32_t inputMaxDelay()
+{
+  return maxDelay;
+}
@@ -0,0 +1,107 @@
+#include "Latency.h"
+
+#ifdef LATENCY
+
+#include "Hal.h"
+
+// Unconsumed presses, by pin
+static uint32_t pressTime[8];
+static uint8_t pressPending = 0;
+
+// Press shown by the next flush
+static bool tagged = false;
+static uint32_t taggedTime;
+// Press whose frame is on the display queue
+static bool marked = false;
+static uint32_t markedTime;
+
+static uint16_t histogram[LATENCY_BUCKETS];
+static uint16_t samples = 0;
+static uint32_t maxLatency = 0;
+
+void latencyPress(uint8_t button, uint32_t time)
+{
+  pressTime[button] = time;
+  pressPending |= 1 << button;
+}
+
+void latencyConsume(uint8_t button)
+{
+  if (!(pressPending & (1 << button)) || tagged || marked)
+  {
+    return;
+  }
+  pressPending &= ~(1 << button);
+  taggedTime = pressTime[button];
+  tagged = true;
+}
+
+void latencyFlush(uint16_t bytes)
+{
+  if (!tagged || !bytes)
+  {
+    return;
+  }
+  halDisplayMark();
+  markedTime = taggedTime;
+  marked = true;
+  tagged = false;
+}
+
+// Upper edge of the bucket that holds the `permille` sample
+static uint32_t percentile(uint16_t permille)
+{
+  uint32_t rank = ((uint32_t)samples * permille + 999) / 1000;
+  uint32_t seen = 0;
+  for (uint8_t i = 0; i < LATENCY_BUCKETS; ++i)
+  {
+    seen += histogram[i];
+    if (seen >= rank)
+    {
+      uint32_t edge = (uint32_t)(i + 1) * LATENCY_BUCKET_US;
+      return edge < maxLatency ? edge : maxLatency;
+    }
+  }
+  return maxLatency;
+}
+
+void latencyReport()
+{
+  halSerialPrint("latency n=");
+  halSerialPrint(samples);
+  halSerialPrint(" p50=");
+  halSerialPrint(percentile(500));
+  halSerialPrint(" p99=");
+  halSerialPrint(percentile(990));
+  halSerialPrint(" max=");
+  halSerialPrint(maxLatency);
+  halSerialPrint("\n");
+}
+
+void latencyUpdate()
+{
+  uint32_t sent;
+  if (!marked || !halDisplayMarkSent(sent))
+  {
+    return;
+  }
+  marked = false;
+  // Full, the report stays as it is
+  if (samples == UINT16_MAX)
+  {
+    return;
+  }
+  uint32_t latency = sent - markedTime;
+  uint32_t bucket = latency / LATENCY_BUCKET_US;
+  histogram[bucket < LATENCY_BUCKETS ? bucket : LATENCY_BUCKETS - 1]++;
+  if (latency > maxLatency)
+  {
+    maxLatency = latency;
+  }
+  if (++samples % LATENCY_REPORT == 0)
+  {
+    latencyReport();
+  }
+}
+
+#endif
@@ -0,0 +1,119 @@
+#include "Persist.h"
+#include "Crc8.h"
+#include "Hal.h"
+
+// Erased EEPROM, never used as a sequence number
+#define SEQUENCE_EMPTY 0xFFFF
+
+static uint8_t slot = PERSIST_SLOTS - 1;
+static uint16_t sequence = SEQUENCE_EMPTY;
+static PersistData saved;
+
+static uint16_t slotAddress(uint8_t index)
+{
+  return PERSIST_EEPROM_START + index * PERSIST_RECORD_SIZE;
+}
+
+// Sequence number of the save after `number`, 0xFFFF is skipped
+static uint16_t successor(uint16_t number)
+{
+  number++;
+  return number == SEQUENCE_EMPTY ? 0 : number;
+}
+
+static uint16_t readSequence(uint8_t index)
+{
+  uint16_t address = slotAddress(index);
+  return halEepromRead(address) | (halEepromRead(address + 1) << 8);
+}
+
+static void encode(uint8_t *record, uint16_t number, const PersistData &data)
+{
+  record[0] = number;
+  record[1] = number >> 8;
+  record[2] = data.highScore;
+  record[3] = data.highScore >> 8;
+  record[4] = data.seed;
+  record[5] = data.seed >> 8;
+  record[6] = data.seed >> 16;
+  record[7] = data.seed >> 24;
+  record[8] = data.startSpeed;
+  record[9] = data.startSpeed >> 8;
+  record[10] = data.backlight;
+  record[11] = crc8(record, PERSIST_RECORD_SIZE - 1);
+}
+
+static bool decode(uint8_t index, PersistData &data)
+{
+  uint8_t record[PERSIST_RECORD_SIZE];
+  uint16_t address = slotAddress(index);
+  for (uint8_t i = 0; i < PERSIST_RECORD_SIZE; ++i)
+  {
+    record[i] = halEepromRead(address + i);
+  }
+  if (crc8(record, PERSIST_RECORD_SIZE - 1) != record[11])
+  {
+    return false;
+  }
+  data.highScore = record[2] | (record[3] << 8);
+  data.seed = record[4] | ((uint32_t)record[5] << 8) | ((uint32_t)record[6] << 16) | ((uint32_t)record[7] << 24);
+  data.startSpeed = record[8] | (record[9] << 8);
+  data.backlight = record[10];
+  return true;
+}
+
+bool persistBegin(PersistData &data)
+{
+  // Only the ends of sequence runs can be the newest record, so the scan
+  // reads two bytes per slot and checks the CRC of the candidates only
+  bool found = false;
+  slot = PERSIST_SLOTS - 1;
+  sequence = SEQUENCE_EMPTY;
+  uint16_t first = readSequence(0);
+  uint16_t next = first;
+  for (uint8_t index = 0; index < PERSIST_SLOTS; ++index)
+  {
+    uint16_t number = next;
+    next = (index + 1 < PERSIST_SLOTS) ? readSequence(index + 1) : first;
+    if (number == SEQUENCE_EMPTY || next == successor(number))
+    {
+      continue;
+    }
+    PersistData candidate;
+    if ((!found || (int16_t)(number - sequence) > 0) && decode(index, candidate))
+    {
+      found = true;
+      slot = index;
+      sequence = number;
+      data = candidate;
+    }
+  }
+  if (found)
+  {
+    saved = data;
+  }
+  return found;
+}
+
+void persistSave(const PersistData &data)
+{
+  if (sequence != SEQUENCE_EMPTY && data.highScore == saved.highScore && data.seed == saved.seed &&
+      data.startSpeed == saved.startSpeed && data.backlight == saved.backlight)
+  {
+    return;
+  }
+  slot = (slot + 1) % PERSIST_SLOTS;
+  sequence = successor(sequence);
+
+  uint8_t record[PERSIST_RECORD_SIZE];
+  encode(record, sequence, data);
+  uint16_t address = slotAddress(slot);
+  // Sequence number last, it makes the record the newest one
+  for (uint8_t i = 2; i < PERSIST_RECORD_SIZE; ++i)
+  {
+    halEepromWrite(address + i, record[i]);
+  }
+  halEepromWrite(address, record[0]);
+  halEepromWrite(address + 1, record[1]);
+  saved = data;
+}
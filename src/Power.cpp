@@ -0,0 +1,140 @@
+#include "Power.h"
+#include "Hal.h"
+
+/*
+Typical supply currents in uA at 5 V, 16 MHz (ATmega328P datasheet and
+common HD44780/PCF8574 modules). Used only for the POWER_STATS estimate.
+*/
+#define CURRENT_MCU_ACTIVE 9500
+#define CURRENT_MCU_IDLE 3500
+#define CURRENT_MCU_POWER_DOWN 1
+#define CURRENT_LCD_LOGIC 1200
+#define CURRENT_LCD_BACKLIGHT 20000
+
+static uint32_t backlightTimeout = POWER_BACKLIGHT_TIMEOUT * 1000UL;
+static uint32_t displayTimeout = POWER_DISPLAY_TIMEOUT * 1000UL;
+static uint32_t lastActivity = 0;
+static bool backlightOn = true;
+static bool displayOn = true;
+
+#ifdef POWER_STATS
+#define POWER_REPORT_INTERVAL 10000
+
+static uint32_t awakeUs[POWER_MAX_STATES];
+static uint32_t idleUs[POWER_MAX_STATES];
+static uint16_t powerDowns[POWER_MAX_STATES];
+static uint32_t wokeAt = 0;
+static uint32_t lastReport = 0;
+
+static void report()
+{
+  for (uint8_t state = 0; state < POWER_MAX_STATES; ++state)
+  {
+    uint32_t total = (awakeUs[state] + idleUs[state]) / 1000;
+    if (total == 0 && powerDowns[state] == 0)
+    {
+      continue;
+    }
+    // Weighted MCU current over the measured time of this state
+    uint32_t mcu = CURRENT_MCU_POWER_DOWN;
+    if (total)
+    {
+      mcu = (awakeUs[state] / 1000 * CURRENT_MCU_ACTIVE + idleUs[state] / 1000 * CURRENT_MCU_IDLE) / total;
+    }
+    uint32_t lcd = (displayOn ? CURRENT_LCD_LOGIC : 0) + (backlightOn ? CURRENT_LCD_BACKLIGHT : 0);
+    halSerialPrint("state ");
+    halSerialPrint(state);
+    halSerialPrint(": awake ");
+    halSerialPrint(total ? awakeUs[state] / 10 / total : 0);
+    halSerialPrint("%, power-downs ");
+    halSerialPrint(powerDowns[state]);
+    halSerialPrint(", datasheet estimate: MCU ");
+    halSerialPrint(mcu);
+    halSerialPrint(" uA + LCD ");
+    halSerialPrint(lcd);
+    halSerialPrint(" uA (not measured)\n");
+    awakeUs[state] = 0;
+    idleUs[state] = 0;
+    powerDowns[state] = 0;
+  }
+}
+#endif
+
+void powerBegin()
+{
+  lastActivity = halMillis();
+  backlightOn = true;
+  displayOn = true;
+#ifdef POWER_STATS
+  halSerialBegin(115200);
+  wokeAt = halMicros();
+  lastReport = lastActivity;
+#endif
+}
+
+void powerSetTimeouts(uint16_t backlightSeconds, uint16_t displaySeconds)
+{
+  backlightTimeout = backlightSeconds * 1000UL;
+  displayTimeout = displaySeconds * 1000UL;
+}
+
+bool powerActivity()
+{
+  bool wasOn = displayOn;
+  lastActivity = halMillis();
+  if (!displayOn)
+  {
+    halDisplayPower(true);
+    displayOn = true;
+  }
+  if (!backlightOn)
+  {
+    halDisplayBacklight(true);
+    backlightOn = true;
+  }
+  return wasOn;
+}
+
+bool powerDisplayOn()
+{
+  return displayOn;
+}
+
+void powerIdle(uint8_t state, bool animating)
+{
+  uint32_t quiet = halMillis() - lastActivity;
+  if (backlightOn && backlightTimeout && quiet >= backlightTimeout)
+  {
+    halDisplayBacklight(false);
+    backlightOn = false;
+  }
+  if (displayOn && displayTimeout && quiet >= displayTimeout)
+  {
+    halDisplayPower(false);
+    displayOn = false;
+  }
+
+  // millis() stops in power-down, so stay in idle while a timeout runs
+  bool timeoutPending = (backlightOn && backlightTimeout) || (displayOn && displayTimeout);
+  uint8_t mode = ((animating && displayOn) || timeoutPending) ? HAL_SLEEP_IDLE : HAL_SLEEP_POWER_DOWN;
+
+#ifdef POWER_STATS
+  uint8_t slot = state < POWER_MAX_STATES ? state : POWER_MAX_STATES - 1;
+  uint32_t sleptAt = halMicros();
+  awakeUs[slot] += sleptAt - wokeAt;
+  halSleep(mode);
+  wokeAt = halMicros();
+  if (mode == HAL_SLEEP_IDLE)
+    idleUs[slot] += wokeAt - sleptAt;
+  else
+    powerDowns[slot]++;
+  if (halMillis() - lastReport >= POWER_REPORT_INTERVAL)
+  {
+    lastReport = halMillis();
+    report();
+  }
+#else
+  (void)state;
+  halSleep(mode);
+#endif
+}
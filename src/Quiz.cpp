@@ -0,0 +1,130 @@
+#include "Quiz.h"
+
+#if QUIZ_FITS_DISPLAY
+
+#include "FrameBuffer.h"
+#include "Hal.h"
+#include "QuizPack.h"
+#include "Rng.h"
+
+static uint8_t state = QUIZ_INTRO;
+static uint8_t asked = 0;
+static uint8_t questions = 0;
+// A round walks the pack in steps of stride from first, with stride and
+// the pack size coprime no question comes twice
+static uint16_t first = 0;
+static uint16_t stride = 1;
+static uint16_t current = 0;
+
+static uint16_t below(Rng &rng, uint16_t max)
+{
+  return ((uint32_t)rngNext(rng) * max) >> 16;
+}
+
+static uint16_t gcd(uint16_t a, uint16_t b)
+{
+  while (b)
+  {
+    uint16_t t = a % b;
+    a = b;
+    b = t;
+  }
+  return a;
+}
+
+static void drawQuestion()
+{
+  QuizPackReader reader;
+  quizPackOpen(reader, current);
+  fb.setCursor(0, 0);
+  quizPackLine(reader);
+  fb.setCursor(0, 1);
+  quizPackLine(reader);
+  fb.setCursor(0, 2);
+  fb.print(F("<- "));
+  quizPackLine(reader);
+  fb.setCursor(FB_COLS - 3 - quizPackRightLength(current), 3);
+  quizPackLine(reader);
+  fb.print(F(" ->"));
+}
+
+void quizBegin()
+{
+  uint16_t count = quizPackCount();
+  Rng rng;
+  rngSeed(rng, rngPool());
+  first = below(rng, count);
+  stride = 1;
+  if (count > 2)
+  {
+    do
+    {
+      stride = 1 + below(rng, count - 1);
+    } while (gcd(stride, count) != 1);
+  }
+  questions = count < QUIZ_ROUND ? count : QUIZ_ROUND;
+  state = QUIZ_INTRO;
+  asked = 0;
+  current = first;
+}
+
+void quizContinue()
+{
+  state = QUIZ_ASKING;
+}
+
+uint8_t quizAnswer(uint8_t side)
+{
+  if (state != QUIZ_ASKING)
+  {
+    return state;
+  }
+  if (side != quizPackCorrect(current))
+  {
+    state = QUIZ_WRONG;
+  }
+  else if (++asked == questions)
+  {
+    state = QUIZ_FINISHED;
+  }
+  else
+  {
+    current = (first + (uint32_t)asked * stride) % quizPackCount();
+  }
+  return state;
+}
+
+uint8_t quizState()
+{
+  return state;
+}
+
+void quizDraw()
+{
+  fb.clear();
+  switch (state)
+  {
+  case QUIZ_INTRO:
+    FB_TEXT(4, 0, "?  Quizz  ?");
+    FB_TEXT(0, 1, " Select the correct ");
+    FB_TEXT(0, 2, "answer using the bt");
+    FB_TEXT(0, 3, "<- Lf_ans   Rg_ans->");
+    break;
+  case QUIZ_ASKING:
+    drawQuestion();
+    break;
+  case QUIZ_WRONG:
+    FB_TEXT(4, 0, "?  Quizz  ?");
+    FB_TEXT(3, 1, "Bad answer :/");
+    FB_TEXT(0, 2, "Play again  Go home");
+    FB_TEXT(0, 3, "  <---       --->  ");
+    break;
+  case QUIZ_FINISHED:
+    FB_TEXT(1, 1, "Congratulations !");
+    FB_TEXT(2, 2, "You know a lot ");
+    FB_TEXT(2, 3, "about arduino ;)");
+    break;
+  }
+}
+
+#endif
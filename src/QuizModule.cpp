@@ -0,0 +1,76 @@
+#include "Quiz.h"
+
+#if QUIZ_FITS_DISPLAY
+
+#include "Game.h"
+#include "Hal.h"
+
+#define QUIZ_INTRO_TIME 3000
+#define QUIZ_FINISHED_TIME 5000
+
+static const char name[] PROGMEM = "Quizz";
+static_assert(sizeof(name) - 1 <= GAME_NAME_LENGTH, "menu entry too long");
+
+// Milliseconds in the current screen
+static uint32_t stateTimer = 0;
+
+static void quizInit()
+{
+  quizBegin();
+  stateTimer = 0;
+}
+
+// Red answers left, Yellow right and plays again after a bad answer
+static bool quizButton(uint8_t button)
+{
+  uint8_t side = (button == ButtonRed) ? QUIZ_LEFT : QUIZ_RIGHT;
+  if (quizState() == QUIZ_ASKING)
+  {
+    if (quizAnswer(side) == QUIZ_FINISHED)
+    {
+      stateTimer = 0;
+    }
+    return true;
+  }
+  if (quizState() == QUIZ_WRONG && button == ButtonYellow)
+  {
+    quizBegin();
+    stateTimer = 0;
+    return true;
+  }
+  return false;
+}
+
+static uint8_t quizTick(uint16_t dt, const uint8_t *events, uint8_t count)
+{
+  stateTimer += dt;
+  uint8_t result = 0;
+  for (uint8_t i = 0; i < count; ++i)
+  {
+    if ((events[i] == ButtonRed || events[i] == ButtonYellow) && quizButton(events[i]))
+      result = GAME_DRAW;
+  }
+
+  switch (quizState())
+  {
+  case QUIZ_INTRO:
+    if (stateTimer >= QUIZ_INTRO_TIME)
+    {
+      quizContinue();
+      return GAME_DRAW;
+    }
+    return result | GAME_ANIMATE;
+  case QUIZ_FINISHED:
+    if (stateTimer >= QUIZ_FINISHED_TIME)
+    {
+      return GAME_EXIT;
+    }
+    return result | GAME_ANIMATE;
+  }
+  // Waiting for an answer
+  return result;
+}
+
+const GameModule quizModule = {name, 0, quizInit, quizTick, quizDraw, 0};
+
+#endif
@@ -0,0 +1,80 @@
+#include "QuizPack.h"
+#include "FrameBuffer.h"
+#include "Hal.h"
+
+#define QUIZ_PACK_TOC_ENTRY 3
+
+uint16_t quizPackCount()
+{
+  return quizPackQuestions;
+}
+
+uint8_t quizPackCorrect(uint16_t question)
+{
+  return pgm_read_byte(&quizPackToc[question * QUIZ_PACK_TOC_ENTRY + 2]) >> 7;
+}
+
+uint8_t quizPackRightLength(uint16_t question)
+{
+  return pgm_read_byte(&quizPackToc[question * QUIZ_PACK_TOC_ENTRY + 2]) & 0x7F;
+}
+
+void quizPackOpen(QuizPackReader &reader, uint16_t question)
+{
+  const uint8_t *entry = &quizPackToc[question * QUIZ_PACK_TOC_ENTRY];
+  reader.byte = pgm_read_byte(entry) | (pgm_read_byte(entry + 1) << 8);
+  reader.bit = 0;
+}
+
+static uint8_t readSymbol(QuizPackReader &reader)
+{
+  // Canonical code: the codes of one length are consecutive numbers,
+  // first is the smallest code of the current length
+  uint16_t code = 0;
+  uint16_t first = 0;
+  uint8_t index = 0;
+  for (uint8_t length = 0; length < QUIZ_PACK_MAX_BITS; ++length)
+  {
+    code |= (pgm_read_byte(&quizPackBits[reader.byte]) >> (7 - reader.bit)) & 1;
+    if (++reader.bit == 8)
+    {
+      reader.bit = 0;
+      reader.byte++;
+    }
+    uint8_t count = pgm_read_byte(&quizPackCodeLengths[length]);
+    if (code - first < count)
+    {
+      return pgm_read_byte(&quizPackSymbols[index + code - first]);
+    }
+    index += count;
+    first = (first + count) << 1;
+    code <<= 1;
+  }
+  // Not a code, the pack is broken; end the line
+  return QUIZ_PACK_END;
+}
+
+uint8_t quizPackLine(QuizPackReader &reader)
+{
+  uint8_t written = 0;
+  for (;;)
+  {
+    uint8_t symbol = readSymbol(reader);
+    if (symbol == QUIZ_PACK_END)
+    {
+      return written;
+    }
+    if (symbol < QUIZ_PACK_WORD)
+    {
+      fb.write(symbol - QUIZ_PACK_CHAR + ' ');
+      written++;
+      continue;
+    }
+    const char *word = quizPackWords + pgm_read_word(&quizPackWordOffsets[symbol - QUIZ_PACK_WORD]);
+    for (char c = pgm_read_byte(word); c; c = pgm_read_byte(++word))
+    {
+      fb.write(c);
+      written++;
+    }
+  }
+}
@@ -0,0 +1,56 @@
+// Generated by tools/quizc.py from assets/quiz.txt, do not edit
+
+#include "QuizPack.h"
+#include "Hal.h"
+
+const uint16_t quizPackQuestions = 10;
+
+// Byte offset (little-endian) and correct side << 7 | right answer length
+const uint8_t quizPackToc[] PROGMEM = {
+    0x00, 0x00, 0x0F, 0x18, 0x00, 0x06, 0x33, 0x00, 0x83, 0x4E, 0x00, 0x04, 0x5C, 0x00, 0x08, 0x79,
+    0x00, 0x89, 0x93, 0x00, 0x0A, 0xB2, 0x00, 0x04, 0xC7, 0x00, 0x8C, 0xE3, 0x00, 0x02,
+};
+
+// Canonical Huffman code: symbols per code length 1..15, symbols in code order
+const uint8_t quizPackCodeLengths[QUIZ_PACK_MAX_BITS] PROGMEM = {0, 0, 1, 2, 9, 16, 20, 10, 12, 0, 0, 0, 0, 0, 0};
+const uint8_t quizPackSymbols[] PROGMEM = {
+    0x00, 0x01, 0x46, 0x42, 0x45, 0x4D, 0x4F, 0x50, 0x53, 0x54, 0x55, 0x65, 0x11, 0x22, 0x44, 0x48,
+    0x4A, 0x4E, 0x56, 0x60, 0x61, 0x62, 0x63, 0x64, 0x66, 0x67, 0x68, 0x69, 0x0C, 0x12, 0x13, 0x1A,
+    0x20, 0x24, 0x25, 0x27, 0x2A, 0x2E, 0x34, 0x43, 0x47, 0x49, 0x4C, 0x51, 0x57, 0x58, 0x5A, 0x6A,
+    0x07, 0x09, 0x0A, 0x23, 0x26, 0x29, 0x2D, 0x33, 0x35, 0x5B, 0x14, 0x15, 0x16, 0x18, 0x19, 0x1B,
+    0x28, 0x2F, 0x30, 0x31, 0x36, 0x37,
+};
+
+// Dictionary entries, NUL-terminated
+const char quizPackWords[] PROGMEM =
+    "rduino\0"
+    "   \0"
+    "What \0"
+    " the\0"
+    " was\0"
+    " a\0"
+    "or \0"
+    "in\0"
+    " ?\0"
+    " Wh\0"
+    " ma\0";
+const uint16_t quizPackWordOffsets[] PROGMEM = {0, 7, 11, 17, 22, 27, 30, 34, 37, 40, 44};
+
+const uint8_t quizPackBits[] PROGMEM = {
+    0xAA, 0xB9, 0x9C, 0x5B, 0xD5, 0x7F, 0x2F, 0xC8, 0x1B, 0xD5, 0x7F, 0x2B, 0xE5, 0x2F, 0x6F, 0x4D,
+    0x43, 0x66, 0xAF, 0x42, 0xE1, 0x74, 0x74, 0x80, 0xC4, 0xDA, 0x76, 0x14, 0x74, 0x82, 0xB4, 0xA4,
+    0x62, 0xDC, 0xF6, 0xD1, 0x23, 0xCD, 0x38, 0x0D, 0x8B, 0x2D, 0x8F, 0x42, 0xBB, 0x0D, 0x8B, 0x2F,
+    0xF6, 0xE8, 0xC0, 0xAD, 0x48, 0x5C, 0xB4, 0x22, 0x53, 0x24, 0xB0, 0xBA, 0x98, 0x2E, 0x6D, 0x64,
+    0xAD, 0x44, 0xF0, 0xA4, 0xAF, 0xD0, 0x3D, 0x7E, 0x36, 0xFB, 0x0D, 0x39, 0x32, 0x00, 0xC4, 0xD7,
+    0x6D, 0x85, 0xA7, 0x00, 0x32, 0xE7, 0xFB, 0xE6, 0x19, 0xA2, 0x8A, 0x20, 0xAE, 0x67, 0x17, 0x87,
+    0x81, 0x5E, 0x5A, 0x72, 0x64, 0xC0, 0x0F, 0xEB, 0x58, 0x9A, 0x24, 0x79, 0x78, 0xC7, 0xFB, 0xD5,
+    0xE4, 0x37, 0x51, 0x39, 0x78, 0xFF, 0x3D, 0xFC, 0x80, 0xAF, 0x9B, 0x59, 0x21, 0xB9, 0xCC, 0x6B,
+    0xA0, 0xD3, 0x15, 0x15, 0xE5, 0x1D, 0x38, 0x0D, 0xDF, 0x1B, 0x7F, 0x02, 0x37, 0xCE, 0x6A, 0x28,
+    0xFF, 0xFE, 0xE0, 0xC5, 0x85, 0x33, 0xAC, 0x85, 0x0F, 0xE2, 0xC6, 0x8A, 0x89, 0x9C, 0x21, 0x4E,
+    0x03, 0x6A, 0x1C, 0xE9, 0xA7, 0x61, 0x79, 0xA1, 0x7F, 0x33, 0x0F, 0x39, 0x94, 0xA2, 0xFD, 0x21,
+    0xE6, 0xE0, 0xAB, 0x14, 0x3C, 0xBB, 0x1A, 0x1B, 0x68, 0xB2, 0x14, 0xF7, 0x49, 0xE8, 0x19, 0xA2,
+    0x8B, 0xEC, 0x32, 0xE7, 0xCF, 0x9C, 0x00, 0x2D, 0x77, 0x75, 0xE2, 0xC9, 0xE1, 0x48, 0xA8, 0xAD,
+    0xEE, 0x93, 0xC0, 0x6B, 0xB9, 0x27, 0xD0, 0xD4, 0xCE, 0x66, 0xD7, 0x0D, 0x77, 0x39, 0xF4, 0x24,
+    0xD6, 0xF7, 0x00, 0x2F, 0x56, 0x75, 0xEE, 0xBE, 0xC5, 0xD0, 0xDA, 0xE9, 0x98, 0xB7, 0x02, 0x67,
+    0x08, 0x35, 0x30, 0x69, 0xD8, 0xD3, 0xD0, 0x3E, 0x9F, 0x51, 0x97, 0x30,
+};
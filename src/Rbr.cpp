@@ -0,0 +1,247 @@
+#include "Rbr.h"
+#include "Hal.h"
+#include "FrameBuffer.h"
+#include "Telemetry.h"
+
+#include "Bcd.h"
+#include "Glyphs.h"
+
+#define SPRITE_EMPTY ' '
+#define SPRITE_JUMP_UPPER '.' // Use the '.' character for the head
+
+// Digits of a uint16_t count, the widest the numbers get
+#define SCORE_DIGITS 5
+#if DISPLAY_ROWS >= 4
+// Labels and numbers below the playfield
+#define TOP_SCORE_COLUMN 15
+static_assert(Display::fits(6, 3, SCORE_DIGITS) && Display::fits(TOP_SCORE_COLUMN, 3, SCORE_DIGITS),
+              "the scores fit below the playfield");
+#else
+// During a run the distance takes the right end of the upper row. The
+// attract and game-over screens print their text and the top score on
+// that row, so they leave the distance out.
+#define TOP_SCORE_COLUMN 11
+static_assert(Display::fits(TOP_SCORE_COLUMN, 0, SCORE_DIGITS) && SCORE_DIGITS < TERRAIN_WIDTH - RBR_HERO_COLUMN,
+              "the scores fit next to the playfield");
+#endif
+
+static RbrGame game = {&rbrDefaultTuning, {RBR_START_SPEED, 0, 0}, HERO_POSITION_RUN_LOWER_1, HERO_POSITION_RUN_LOWER_1,
+                       {}, {}, {}, 0, 0, 0, 0};
+
+// Outcome of the last rbrStep(), for rbrDrawStep()
+static bool stepAlive = true;
+
+// The numbers on screen: game.distance >> 3 as of the start of the last
+// tick, game.level and game.carry.highScore. They count along with the
+// game instead of being converted for every frame.
+static BcdCounter shownDistance = {{0}, 1, 0};
+static BcdCounter shownLevel = {{0}, 1, 0};
+static BcdCounter shownTop = {{0}, 1, 0};
+// The last tick reached the next multiple of 8, shown from the next one on
+static bool distancePending = false;
+// The screen was cleared for a new game, the labels need drawing again
+static bool fullDraw = true;
+
+// Character codes of the glyphs, valid while acquired
+static uint8_t sprite[GLYPH_COUNT];
+// Character code for each TERRAIN_CELL_*
+static uint8_t terrainChar[TERRAIN_CELLS] = {SPRITE_EMPTY};
+// Character code for each HERO_SPRITE_*
+static uint8_t heroChar[HERO_SPRITES] = {SPRITE_EMPTY};
+
+static const uint8_t rbrGlyphs[] = {GLYPH_RUN_1, GLYPH_RUN_2, GLYPH_JUMP, GLYPH_JUMP_LOWER,
+                                    GLYPH_SOLID, GLYPH_SOLID_RIGHT, GLYPH_SOLID_LEFT};
+
+void rbrAcquireGlyphs()
+{
+  for (uint8_t i = 0; i < sizeof(rbrGlyphs); ++i)
+  {
+    sprite[rbrGlyphs[i]] = glyphAcquire(rbrGlyphs[i]);
+  }
+  terrainChar[TERRAIN_CELL_SOLID_RIGHT] = sprite[GLYPH_SOLID_RIGHT];
+  terrainChar[TERRAIN_CELL_SOLID_LEFT] = sprite[GLYPH_SOLID_LEFT];
+  terrainChar[TERRAIN_CELL_SOLID] = sprite[GLYPH_SOLID];
+  heroChar[HERO_SPRITE_RUN_1] = sprite[GLYPH_RUN_1];
+  heroChar[HERO_SPRITE_RUN_2] = sprite[GLYPH_RUN_2];
+  heroChar[HERO_SPRITE_JUMP] = sprite[GLYPH_JUMP];
+  heroChar[HERO_SPRITE_JUMP_LOWER] = sprite[GLYPH_JUMP_LOWER];
+  heroChar[HERO_SPRITE_HEAD] = SPRITE_JUMP_UPPER;
+}
+
+void rbrReleaseGlyphs()
+{
+  for (uint8_t i = 0; i < sizeof(rbrGlyphs); ++i)
+  {
+    glyphRelease(rbrGlyphs[i]);
+  }
+}
+
+// Draw one terrain row, the hero sprite (if any) replaces its cell
+static void drawTerrain(const TerrainRow &row, uint8_t width, char hero)
+{
+  uint32_t left = row.left;
+  uint32_t right = row.right;
+  for (uint8_t cell = 0; cell < width; ++cell)
+  {
+    if (cell == RBR_HERO_COLUMN && hero != SPRITE_EMPTY)
+      fb.write(hero);
+    else
+      fb.write(terrainChar[terrainCell(left & 1, right & 1)]);
+    left >>= 1;
+    right >>= 1;
+  }
+}
+
+static void drawHero(byte position, bool all, bool distance)
+{
+  byte sprites = rbrHeroSprites(position);
+  byte upper = heroChar[sprites >> 4];
+  byte lower = heroChar[sprites & 0x0F];
+
+  // Draw the scene
+#if DISPLAY_ROWS >= 4
+  fb.setCursor(0, 0);
+  drawTerrain(game.upper, TERRAIN_WIDTH, upper);
+  fb.setCursor(0, 1);
+  drawTerrain(game.lower, TERRAIN_WIDTH, lower);
+  if (all)
+  {
+    FB_TEXT(0, 3, "Dist ");
+    FB_TEXT(0, 2, "Score");
+  }
+  bcdDraw(shownDistance, 6, 3, all);
+  bcdDraw(shownLevel, 6, 2, all);
+  (void)distance;
+#else
+  fb.setCursor(0, 0);
+  drawTerrain(game.upper, TERRAIN_WIDTH - (distance ? shownDistance.length : 0), upper);
+  fb.setCursor(0, 1);
+  drawTerrain(game.lower, TERRAIN_WIDTH, lower);
+  if (distance)
+  {
+    bcdDraw(shownDistance, TERRAIN_WIDTH - shownDistance.length, 0, all);
+  }
+#endif
+}
+
+static void clearShownScore()
+{
+  bcdClear(shownDistance);
+  bcdClear(shownLevel);
+  distancePending = false;
+}
+
+void rbrNewGame(uint32_t seed)
+{
+  rbrGameNew(game, seed);
+  clearShownScore();
+  fullDraw = true;
+}
+
+void rbrClearScore()
+{
+  game.distance = 0;
+  game.level = 0;
+  clearShownScore();
+}
+
+void rbrDrawTopScore()
+{
+#if DISPLAY_ROWS >= 4
+  FB_TEXT(11, 2, "Top Score");
+  bcdDraw(shownTop, TOP_SCORE_COLUMN, 3, true);
+#else
+  FB_TEXT(1, 0, "Top Score ");
+  bcdDraw(shownTop, TOP_SCORE_COLUMN, 0, true);
+#endif
+}
+
+bool rbrStep(bool jump)
+{
+  // The distance shown is the one the tick started with
+  if (distancePending)
+  {
+    bcdIncrement(shownDistance);
+    distancePending = false;
+  }
+  uint16_t level = game.level;
+  uint16_t start = telemetryTime();
+  stepAlive = rbrGameStep(game, jump);
+  telemetryAdd(TELEMETRY_TERRAIN, start);
+  if (game.level != level)
+  {
+    bcdIncrement(shownLevel);
+  }
+  if (stepAlive)
+  {
+    distancePending = (game.distance & 7) == 0;
+    if (bcdCompare(shownLevel, shownTop) > 0)
+    {
+      bcdCopy(shownTop, shownLevel);
+    }
+  }
+  return stepAlive;
+}
+
+void rbrDrawStep()
+{
+  uint16_t start = telemetryTime();
+  drawHero(game.pose, fullDraw, true);
+#if DISPLAY_ROWS >= 4
+  if (stepAlive)
+  {
+    // Only the digits that changed, the label stays from the first tick
+    if (fullDraw)
+    {
+      FB_TEXT(11, 2, "Top Score");
+    }
+    bcdDraw(shownTop, TOP_SCORE_COLUMN, 3, fullDraw);
+  }
+#endif
+  fullDraw = false;
+  telemetryAdd(TELEMETRY_RENDER, start);
+}
+
+void rbrDraw(bool hero)
+{
+  uint16_t start = telemetryTime();
+  if (distancePending)
+  {
+    bcdIncrement(shownDistance);
+    distancePending = false;
+  }
+  drawHero(hero ? game.hero : HERO_POSITION_OFF, true, false);
+  fullDraw = false;
+  telemetryAdd(TELEMETRY_RENDER, start);
+}
+
+uint16_t rbrTickPeriod()
+{
+  return game.carry.speed;
+}
+
+uint16_t rbrDistance()
+{
+  return game.distance;
+}
+
+bool rbrObstacleAhead()
+{
+  return terrainSolid(game.lower, RBR_HERO_COLUMN + 2);
+}
+
+bool rbrTookOff()
+{
+  return game.pose == HERO_POSITION_JUMP_1;
+}
+
+void rbrSaveCarry(RbrCarry &carry)
+{
+  carry = game.carry;
+}
+
+void rbrLoadCarry(const RbrCarry &carry)
+{
+  game.carry = carry;
+  bcdSet(shownTop, carry.highScore);
+}
@@ -0,0 +1,174 @@
+#include "RbrGame.h"
+
+#include "Hal.h"
+
+const RbrTuning rbrDefaultTuning = {3, 2, 10, 10, 10, 25, 4};
+
+/*
+The jump arc, frame by frame (one frame per tick): the sprites in the
+upper and lower row. A jump rises, spends `hang` frames on the upper row
+and falls; a shorter hang than RBR_JUMP_HANG_MAX skips the first hang
+frames. From every hang frame but the last the hero lands on a lower
+block below it, and running off the end of a block joins the arc with
+JUMP_DROP hang frames left.
+*/
+struct HeroFrame
+{
+  uint8_t upper;
+  uint8_t lower;
+};
+
+static constexpr HeroFrame arcRise[] = {
+    {HERO_SPRITE_NONE, HERO_SPRITE_JUMP},
+    {HERO_SPRITE_HEAD, HERO_SPRITE_JUMP_LOWER},
+};
+static constexpr HeroFrame arcHang = {HERO_SPRITE_JUMP, HERO_SPRITE_NONE};
+static constexpr HeroFrame arcFall[] = {
+    {HERO_SPRITE_HEAD, HERO_SPRITE_JUMP_LOWER},
+    {HERO_SPRITE_NONE, HERO_SPRITE_JUMP},
+};
+#define JUMP_DROP 2
+
+#define RISE_FRAMES (sizeof(arcRise) / sizeof(arcRise[0]))
+#define FALL_FRAMES (sizeof(arcFall) / sizeof(arcFall[0]))
+#define HANG_FIRST (HERO_POSITION_JUMP_1 + RISE_FRAMES)
+#define HANG_LAST (HANG_FIRST + RBR_JUMP_HANG_MAX - 1)
+#define FALL_LAST (HANG_LAST + FALL_FRAMES)
+
+static_assert(RISE_FRAMES + RBR_JUMP_HANG_MAX + FALL_FRAMES == RBR_JUMP_FRAMES, "RBR_JUMP_FRAMES is off");
+static_assert(HERO_POSITIONS <= 16, "positions are packed in nibbles");
+
+struct HeroTables
+{
+  // HERO_SPRITE_* upper << 4 | lower
+  uint8_t sprites[HERO_POSITIONS];
+  // Next position for each hang, low nibble with nothing solid below,
+  // high nibble on a lower block
+  uint8_t next[RBR_JUMP_HANG_MAX][HERO_POSITIONS];
+};
+
+static constexpr uint8_t packSprites(HeroFrame frame)
+{
+  return frame.upper << 4 | frame.lower;
+}
+
+static constexpr uint8_t packNext(uint8_t free, uint8_t solid)
+{
+  return free | solid << 4;
+}
+
+static constexpr HeroTables makeHeroTables()
+{
+  HeroTables t = {};
+  t.sprites[HERO_POSITION_OFF] = packSprites({HERO_SPRITE_NONE, HERO_SPRITE_NONE});
+  t.sprites[HERO_POSITION_RUN_LOWER_1] = packSprites({HERO_SPRITE_NONE, HERO_SPRITE_RUN_1});
+  t.sprites[HERO_POSITION_RUN_LOWER_2] = packSprites({HERO_SPRITE_NONE, HERO_SPRITE_RUN_2});
+  for (uint8_t i = 0; i < RISE_FRAMES; ++i)
+    t.sprites[HERO_POSITION_JUMP_1 + i] = packSprites(arcRise[i]);
+  for (uint8_t i = HANG_FIRST; i <= HANG_LAST; ++i)
+    t.sprites[i] = packSprites(arcHang);
+  for (uint8_t i = 0; i < FALL_FRAMES; ++i)
+    t.sprites[HANG_LAST + 1 + i] = packSprites(arcFall[i]);
+  t.sprites[HERO_POSITION_RUN_UPPER_1] = packSprites({HERO_SPRITE_RUN_1, HERO_SPRITE_NONE});
+  t.sprites[HERO_POSITION_RUN_UPPER_2] = packSprites({HERO_SPRITE_RUN_2, HERO_SPRITE_NONE});
+
+  for (uint8_t hang = 1; hang <= RBR_JUMP_HANG_MAX; ++hang)
+  {
+    uint8_t *next = t.next[hang - 1];
+    for (uint8_t pose = 0; pose < HERO_POSITIONS; ++pose)
+      next[pose] = packNext(pose + 1, pose + 1);
+    next[HERO_POSITION_RUN_LOWER_2] = packNext(HERO_POSITION_RUN_LOWER_1, HERO_POSITION_RUN_LOWER_1);
+    next[HANG_FIRST - 1] = packNext(HANG_LAST + 1 - hang, HANG_LAST + 1 - hang);
+    for (uint8_t pose = HANG_FIRST; pose < HANG_LAST; ++pose)
+      next[pose] = packNext(pose + 1, HERO_POSITION_RUN_UPPER_1);
+    next[FALL_LAST] = packNext(HERO_POSITION_RUN_LOWER_1, HERO_POSITION_RUN_LOWER_1);
+    next[HERO_POSITION_RUN_UPPER_1] = packNext(HANG_LAST + 1 - JUMP_DROP, HERO_POSITION_RUN_UPPER_2);
+    next[HERO_POSITION_RUN_UPPER_2] = packNext(HANG_LAST + 1 - JUMP_DROP, HERO_POSITION_RUN_UPPER_1);
+  }
+  return t;
+}
+
+static constexpr HeroTables heroTables PROGMEM = makeHeroTables();
+
+void rbrGameNew(RbrGame &game, uint32_t seed)
+{
+  rngSeed(game.rng, seed);
+  game.upper.left = game.upper.right = 0;
+  game.lower.left = game.lower.right = 0;
+  game.hero = game.pose = HERO_POSITION_RUN_LOWER_1;
+  game.terrainType = TERRAIN_EMPTY;
+  game.terrainDuration = 1;
+  game.distance = 0;
+  game.level = 0;
+}
+
+void rbrTerrainStep(RbrGame &game)
+{
+  const RbrTuning &tuning = *game.tuning;
+
+  // Shift the terrain to the left
+  terrainAdvance(game.lower, game.terrainType == TERRAIN_LOWER_BLOCK);
+  terrainAdvance(game.upper, game.terrainType == TERRAIN_UPPER_BLOCK);
+
+  // Make new terrain to enter on the right
+  if (--game.terrainDuration == 0)
+  {
+    if (game.terrainType == TERRAIN_EMPTY)
+    {
+      game.terrainType = (rngBelow(game.rng, tuning.upperOdds) == 0) ? TERRAIN_UPPER_BLOCK : TERRAIN_LOWER_BLOCK;
+      game.terrainDuration = tuning.blockMin + rngBelow(game.rng, tuning.blockRange);
+    }
+    else
+    {
+      game.terrainType = TERRAIN_EMPTY;
+      game.terrainDuration = tuning.gapMin + rngBelow(game.rng, tuning.gapRange);
+    }
+  }
+}
+
+uint8_t rbrHeroSprites(uint8_t pose)
+{
+  return pgm_read_byte(&heroTables.sprites[pose]);
+}
+
+bool rbrHeroCollides(uint8_t pose, bool upperSolid, bool lowerSolid)
+{
+  uint8_t sprites = rbrHeroSprites(pose);
+  return ((sprites >> 4) && upperSolid) || ((sprites & 0x0F) && lowerSolid);
+}
+
+uint8_t rbrHeroNext(uint8_t pose, bool lowerSolid, uint8_t hang)
+{
+  uint8_t next = pgm_read_byte(&heroTables.next[hang - 1][pose]);
+  return lowerSolid ? next >> 4 : next & 0x0F;
+}
+
+bool rbrGameStep(RbrGame &game, bool jump)
+{
+  RbrCarry &carry = game.carry;
+
+  rbrTerrainStep(game);
+  game.pose = rbrHeroJump(game.hero, jump);
+  if (carry.stage == game.tuning->stagesPerLevel)
+  {
+    carry.stage = 0;
+    game.level++;
+    carry.speed--;
+  }
+
+  bool lowerSolid = terrainSolid(game.lower, RBR_HERO_COLUMN);
+  if (rbrHeroCollides(game.pose, terrainSolid(game.upper, RBR_HERO_COLUMN), lowerSolid))
+  {
+    // The hero collided with something. Too bad.
+    game.hero = game.pose;
+    return false;
+  }
+  game.hero = rbrHeroNext(game.pose, lowerSolid, game.tuning->jumpHang);
+  game.distance++;
+  carry.stage++;
+  if (game.level > carry.highScore)
+  {
+    carry.highScore = game.level;
+  }
+  return true;
+}
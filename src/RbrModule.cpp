@@ -0,0 +1,215 @@
+#include "Game.h"
+#include "FrameBuffer.h"
+#include "FrameScheduler.h"
+#include "Hal.h"
+#include "Latency.h"
+#include "Persist.h"
+#include "Rbr.h"
+#include "Replay.h"
+#include "Rng.h"
+
+// Attract screen: hero shown, "Press To Start" shown, text cleared
+#define ATTRACT_PHASES 3
+static const uint16_t attractPeriod[ATTRACT_PHASES] = {150, 350, 150};
+static FrameScheduler frameClock;
+
+static const char name[] PROGMEM = "RBR";
+static_assert(sizeof(name) - 1 <= GAME_NAME_LENGTH, "menu entry too long");
+
+static bool playing = false;
+// Yellow presses not yet taken by a logic tick, one jump per tick
+static uint8_t jumpsPressed = 0;
+static bool replayPressed = false;
+// Jumps come from the recording, the live carry-over state is parked here
+static bool replaying = false;
+static RbrCarry liveCarry;
+static byte attractPhase = 0;
+
+// What render() draws besides a pending clear
+#define VIEW_NONE 0
+#define VIEW_ATTRACT 1 // Attract phase `shownPhase`
+#define VIEW_STEP 2    // The last logic tick
+static bool clearPending = false;
+static byte view = VIEW_NONE;
+static byte shownPhase = 0;
+
+static void rbrInit()
+{
+  rbrAcquireGlyphs();
+  playing = false;
+  jumpsPressed = 0;
+  replayPressed = false;
+  attractPhase = 0;
+  clearPending = true;
+  view = VIEW_NONE;
+  frameClock.start(attractPeriod[0]);
+}
+
+// False when there was nothing to replay
+static bool rbrStart()
+{
+  ReplayHeader header;
+  if (replayPressed)
+  {
+    // Replay the last recorded run, if there is one
+    replayPressed = false;
+    if (!replayPlayBegin(header))
+      return false;
+    rbrSaveCarry(liveCarry);
+    rbrLoadCarry(header.carry);
+    replaying = true;
+  }
+  else
+  {
+    // Boot noise and the timing of every press so far seed the terrain
+    header.seed = rngPool();
+    settings.seed = header.seed;
+    rbrSaveCarry(header.carry);
+    replayRecordBegin(header);
+    replaying = false;
+  }
+  rbrNewGame(header.seed);
+  playing = true;
+  jumpsPressed = 0;
+  frameClock.start(rbrTickPeriod());
+  return true;
+}
+
+static void rbrStop()
+{
+  playing = false;
+  if (replaying)
+  {
+    rbrLoadCarry(liveCarry);
+    replaying = false;
+  }
+}
+
+static uint8_t rbrTick(uint16_t dt, const uint8_t *events, uint8_t count)
+{
+  // The frame scheduler keeps the game's own time
+  (void)dt;
+  for (uint8_t i = 0; i < count; ++i)
+  {
+    if (events[i] == ButtonYellow && jumpsPressed < 255)
+      jumpsPressed++;
+    // Green only counts on the attract screen, and not after the Yellow
+    // that starts a run
+    if (events[i] == ButtonGreen && !playing && !jumpsPressed)
+      replayPressed = true;
+  }
+
+  if (!playing && (jumpsPressed || replayPressed))
+  {
+    if (!rbrStart())
+      return GAME_ANIMATE;
+    // The first tick is due now, its frame drops the attract screen text
+    // and redraws the rest
+    clearPending = true;
+  }
+  else if (!playing)
+  {
+    if (!frameClock.update())
+    {
+      return GAME_ANIMATE;
+    }
+    view = VIEW_ATTRACT;
+    shownPhase = attractPhase;
+    frameClock.setPeriod(attractPeriod[attractPhase]);
+    attractPhase = (attractPhase + 1) % ATTRACT_PHASES;
+    return GAME_ANIMATE | GAME_DRAW;
+  }
+
+  // Run every logic tick that is due, render once afterwards
+  uint8_t ticks = frameClock.update();
+  while (ticks-- && playing)
+  {
+    bool jump = jumpsPressed;
+    if (jump)
+      jumpsPressed--;
+    if (replaying)
+      jump = replayPlayTick();
+    else
+      replayRecordTick(jump);
+
+    bool alive = rbrStep(jump);
+    if (jump && !replaying && rbrTookOff())
+      latencyConsume(ButtonYellow);
+    if (!alive)
+    {
+      if (!replaying)
+      {
+        RbrCarry carry;
+        rbrSaveCarry(carry);
+        settings.highScore = carry.highScore;
+        persistSave(settings);
+        replayRecordEnd(rbrDistance());
+#ifdef REPLAY_SERIAL
+        replayDump();
+#endif
+      }
+      rbrStop();
+      attractPhase = 0;
+      frameClock.start(attractPeriod[0]);
+    }
+    else
+    {
+      halLed(rbrObstacleAhead());
+      frameClock.setPeriod(rbrTickPeriod());
+    }
+  }
+  if (!frameClock.rendered())
+  {
+    return GAME_ANIMATE;
+  }
+  view = VIEW_STEP;
+  gameLate(frameClock.lastOverrun());
+  return GAME_ANIMATE | GAME_DRAW;
+}
+
+static void rbrRender()
+{
+  if (clearPending)
+  {
+    fb.clear();
+    clearPending = false;
+  }
+  if (view == VIEW_STEP)
+  {
+    rbrDrawStep();
+    return;
+  }
+  if (view != VIEW_ATTRACT)
+  {
+    return;
+  }
+  rbrDraw(shownPhase == 0);
+  if (shownPhase == 1)
+  {
+#if DISPLAY_ROWS >= 4
+    FB_TEXT(3, 0, "Press To Start ");
+#else
+    FB_TEXT(1, 0, "Press To Start");
+#endif
+  }
+  else if (shownPhase == 2)
+  {
+#if DISPLAY_ROWS >= 4
+    FB_TEXT(3, 0, "               ");
+    FB_TEXT(5, 2, "    ");
+    FB_TEXT(5, 3, "    ");
+#endif
+    rbrDrawTopScore();
+  }
+}
+
+static void rbrExit()
+{
+  halLed(false);
+  // A run left with Blue is not recorded
+  rbrStop();
+  rbrClearScore();
+  rbrReleaseGlyphs();
+}
+
+const GameModule rbrModule = {name, 0, rbrInit, rbrTick, rbrRender, rbrExit};
@@ -0,0 +1,291 @@
+#include "Replay.h"
+#include "Crc8.h"
+#include "Hal.h"
+#include "FrameBuffer.h"
+
+#define RING_SIZE (REPLAY_EEPROM_END - REPLAY_EEPROM_START)
+#define NO_SLOT 0xFF
+
+// The last valid run and the slot the next one starts in
+static uint8_t lastSlot = NO_SLOT;
+static uint16_t lastSequence;
+static uint8_t nextSlot = 0;
+
+// Ring offset of the next byte, not wrapped, and where the run has to end
+static uint16_t offset;
+static uint16_t limit;
+static uint8_t runSlot;
+static uint16_t ticks;
+// Recording ran out of space / playback reached the end marker
+static bool full;
+static bool ended;
+static ReplayHeader recording;
+
+static uint16_t ringAddress(uint16_t at)
+{
+  return REPLAY_EEPROM_START + at % RING_SIZE;
+}
+
+// Offsets of a run in `slot`: its header and the first byte it may not use
+static uint16_t slotStart(uint8_t slot)
+{
+  return slot * REPLAY_SLOT_SIZE;
+}
+
+static uint16_t slotLimit(uint8_t slot)
+{
+  return slotStart(slot) + RING_SIZE;
+}
+
+// First slot at or after the ring offset `at`
+static uint8_t slotAt(uint16_t at)
+{
+  return ((at + REPLAY_SLOT_SIZE - 1) / REPLAY_SLOT_SIZE) % REPLAY_SLOTS;
+}
+
+static uint16_t get16(const uint8_t *bytes)
+{
+  return bytes[0] | (bytes[1] << 8);
+}
+
+static void put16(uint8_t *bytes, uint16_t value)
+{
+  bytes[0] = value;
+  bytes[1] = value >> 8;
+}
+
+// Header of the run in `slot`, false unless it is valid
+static bool readHeader(uint8_t slot, uint16_t &sequence, ReplayHeader &header)
+{
+  uint8_t bytes[REPLAY_HEADER_SIZE];
+  for (uint8_t i = 0; i < REPLAY_HEADER_SIZE; ++i)
+  {
+    bytes[i] = halEepromRead(ringAddress(slotStart(slot) + i));
+  }
+  if (bytes[0] != 'R' || bytes[1] != 'B' || bytes[2] != REPLAY_VERSION ||
+      bytes[REPLAY_HEADER_SIZE - 1] != crc8(bytes, REPLAY_HEADER_SIZE - 1))
+  {
+    return false;
+  }
+  sequence = get16(bytes + 3);
+  header.seed = get16(bytes + 5) | ((uint32_t)get16(bytes + 7) << 16);
+  header.carry.speed = get16(bytes + 9);
+  header.carry.stage = bytes[11];
+  header.carry.highScore = get16(bytes + 12);
+  header.distance = get16(bytes + 14);
+  return true;
+}
+
+// Ring offset just past the end marker of the run in `slot`
+static uint16_t runEnd(uint8_t slot)
+{
+  uint16_t at = slotStart(slot) + REPLAY_HEADER_SIZE;
+  bool entryStart = true;
+  while (at < slotLimit(slot))
+  {
+    uint8_t value = halEepromRead(ringAddress(at++));
+    if (entryStart && value == 0)
+    {
+      break;
+    }
+    entryStart = !(value & 0x80);
+  }
+  return at;
+}
+
+void replayBegin()
+{
+  lastSlot = NO_SLOT;
+  for (uint8_t slot = 0; slot < REPLAY_SLOTS; ++slot)
+  {
+    uint16_t sequence;
+    ReplayHeader header;
+    if (readHeader(slot, sequence, header) &&
+        (lastSlot == NO_SLOT || (int16_t)(sequence - lastSequence) > 0))
+    {
+      lastSlot = slot;
+      lastSequence = sequence;
+    }
+  }
+  nextSlot = lastSlot == NO_SLOT ? 0 : slotAt(runEnd(lastSlot));
+}
+
+static bool put(uint8_t value)
+{
+  if (full || offset >= limit)
+  {
+    full = true;
+    return false;
+  }
+  halEepromWrite(ringAddress(offset++), value);
+  return true;
+}
+
+void replayRecordBegin(const ReplayHeader &header)
+{
+  recording = header;
+  runSlot = nextSlot;
+  // A run recorded here before loses its jumps now
+  halEepromWrite(ringAddress(slotStart(runSlot)), 0xFF);
+  offset = slotStart(runSlot) + REPLAY_HEADER_SIZE;
+  limit = slotLimit(runSlot);
+  ticks = 0;
+  full = false;
+}
+
+void replayRecordTick(bool jump)
+{
+  ticks++;
+  if (!jump)
+  {
+    return;
+  }
+  uint16_t value = ticks;
+  while (value > 0x7F)
+  {
+    put(value | 0x80);
+    value >>= 7;
+  }
+  put(value);
+  ticks = 0;
+}
+
+void replayRecordEnd(uint16_t distance)
+{
+  if (!put(0))
+  {
+    return;
+  }
+  uint16_t sequence = lastSlot == NO_SLOT ? 0 : lastSequence + 1;
+  uint8_t bytes[REPLAY_HEADER_SIZE];
+  bytes[0] = 'R';
+  bytes[1] = 'B';
+  bytes[2] = REPLAY_VERSION;
+  put16(bytes + 3, sequence);
+  put16(bytes + 5, recording.seed);
+  put16(bytes + 7, recording.seed >> 16);
+  put16(bytes + 9, recording.carry.speed);
+  bytes[11] = recording.carry.stage;
+  put16(bytes + 12, recording.carry.highScore);
+  put16(bytes + 14, distance);
+  bytes[REPLAY_HEADER_SIZE - 1] = crc8(bytes, REPLAY_HEADER_SIZE - 1);
+  // Valid only once everything else is in place, the magic goes last
+  for (uint8_t i = REPLAY_HEADER_SIZE; i-- > 0;)
+  {
+    halEepromWrite(ringAddress(slotStart(runSlot) + i), bytes[i]);
+  }
+  lastSlot = runSlot;
+  lastSequence = sequence;
+  nextSlot = slotAt(offset);
+}
+
+bool replayPlayBegin(ReplayHeader &header)
+{
+  uint16_t sequence;
+  // A long run that was aborted may have overwritten the last one
+  if (lastSlot == NO_SLOT || !readHeader(lastSlot, sequence, header))
+  {
+    return false;
+  }
+  offset = slotStart(lastSlot) + REPLAY_HEADER_SIZE;
+  limit = slotLimit(lastSlot);
+  ticks = 0;
+  ended = false;
+  return true;
+}
+
+bool replayPlayTick()
+{
+  if (ended)
+  {
+    return false;
+  }
+  if (ticks == 0)
+  {
+    // Fetch the distance to the next jump
+    uint8_t shift = 0;
+    uint8_t value;
+    do
+    {
+      if (offset >= limit)
+      {
+        ended = true;
+        return false;
+      }
+      value = halEepromRead(ringAddress(offset++));
+      ticks |= (uint16_t)(value & 0x7F) << shift;
+      shift += 7;
+    } while (value & 0x80);
+    if (ticks == 0)
+    {
+      ended = true;
+      return false;
+    }
+  }
+  return --ticks == 0;
+}
+
+void replayDump()
+{
+  static const char digits[] = "0123456789abcdef";
+  char line[2 * 16 + 2];
+  uint8_t length = 0;
+  uint16_t sequence;
+  ReplayHeader header;
+  if (lastSlot == NO_SLOT || !readHeader(lastSlot, sequence, header))
+  {
+    halSerialPrint("no recording\n");
+    return;
+  }
+  // Only up to the end marker
+  uint16_t end = runEnd(lastSlot);
+  for (uint16_t at = slotStart(lastSlot); at < end; ++at)
+  {
+    uint8_t value = halEepromRead(ringAddress(at));
+    line[length++] = digits[value >> 4];
+    line[length++] = digits[value & 0x0F];
+    if (length == 2 * 16 || at + 1 == end)
+    {
+      line[length++] = '\n';
+      line[length] = '\0';
+      halSerialPrint(line);
+      length = 0;
+    }
+  }
+}
+
+bool replayRun()
+{
+  ReplayHeader header;
+  replayBegin();
+  if (!replayPlayBegin(header))
+  {
+    halSerialPrint("no recording\n");
+    return false;
+  }
+  RbrCarry carry;
+  rbrSaveCarry(carry);
+  rbrLoadCarry(header.carry);
+  rbrAcquireGlyphs();
+  fb.clear();
+  rbrNewGame(header.seed);
+  while (rbrStep(replayPlayTick()))
+  {
+    rbrDrawStep();
+    fb.flush();
+    // The host build only moves its virtual clock on
+    halDelay(rbrTickPeriod());
+  }
+  rbrDrawStep();
+  fb.flush();
+  uint16_t distance = rbrDistance();
+  rbrReleaseGlyphs();
+  rbrLoadCarry(carry);
+
+  halSerialPrint("replay: distance ");
+  halSerialPrint(distance);
+  halSerialPrint(", recorded ");
+  halSerialPrint(header.distance);
+  halSerialPrint(distance == header.distance ? "\n" : " MISMATCH\n");
+  return distance == header.distance;
+}
@@ -0,0 +1,39 @@
+#include "Rng.h"
+
+#define RNG_DEFAULT_SEED 0xACE1
+
+static uint32_t pool = 0;
+
+void rngSeed(Rng &rng, uint32_t seed)
+{
+  uint16_t state = seed ^ (seed >> 16);
+  rng.state = state ? state : RNG_DEFAULT_SEED;
+}
+
+uint16_t rngNext(Rng &rng)
+{
+  // Shifts by 8 and 9 are byte moves on the AVR
+  uint16_t x = rng.state;
+  x ^= x << 7;
+  x ^= x >> 9;
+  x ^= x << 8;
+  rng.state = x;
+  return x;
+}
+
+uint8_t rngBelow(Rng &rng, uint8_t max)
+{
+  // The high part of next * max is evenly spread over [0, max) to within
+  // one count in 65535 / max
+  return ((uint32_t)rngNext(rng) * max) >> 16;
+}
+
+void rngStir(uint32_t value)
+{
+  pool = ((pool << 7) | (pool >> 25)) ^ value;
+}
+
+uint32_t rngPool()
+{
+  return pool;
+}
@@ -0,0 +1,109 @@
+#include "Stack.h"
+#include "Hal.h"
+
+#ifdef ARDUINO
+// Fill byte of the unused stack
+#define STACK_PAINT 0xA5
+
+extern uint8_t __heap_start;
+extern void *__brkval;
+// Painted bytes above the heap nothing has written yet
+static uint16_t untouched = 0;
+
+static uint8_t *heapEnd()
+{
+  return __brkval ? (uint8_t *)__brkval : &__heap_start;
+}
+
+void stackPaint()
+{
+  uint8_t *bottom = heapEnd();
+  uint8_t *top = (uint8_t *)SP;
+  for (uint8_t *p = bottom; p < top; ++p)
+  {
+    *p = STACK_PAINT;
+  }
+  untouched = top - bottom;
+}
+
+uint16_t stackFree()
+{
+  return (uint8_t *)SP - heapEnd();
+}
+
+uint16_t stackFreeMin()
+{
+  const uint8_t *bottom = heapEnd();
+  uint16_t intact = 0;
+  while (intact < untouched && bottom[intact] == STACK_PAINT)
+  {
+    intact++;
+  }
+  untouched = intact;
+  return untouched;
+}
+
+uint16_t stackDepth()
+{
+  const uint8_t *deepest = heapEnd() + stackFreeMin();
+  return (const uint8_t *)RAMEND + 1 - deepest;
+}
+#else
+// The host has no SRAM to speak of
+void stackPaint()
+{
+}
+
+uint16_t stackFree()
+{
+  return 0;
+}
+
+uint16_t stackFreeMin()
+{
+  return 0;
+}
+
+uint16_t stackDepth()
+{
+  return 0;
+}
+#endif
+
+#ifdef STACK_MONITOR
+static uint8_t session = 0xFF;
+static uint16_t deepest[STACK_MAX_STATES];
+
+static void report(uint8_t state, uint16_t depth)
+{
+  halSerialPrint("stack state ");
+  halSerialPrint(state);
+  halSerialPrint(": ");
+  halSerialPrint(depth);
+  halSerialPrint(" bytes deep, ");
+  halSerialPrint(deepest[state]);
+  halSerialPrint(" at most, ");
+  halSerialPrint(stackFreeMin());
+  halSerialPrint(" bytes never touched\n");
+}
+
+void stackMonitor(uint8_t state)
+{
+  if (state == session)
+  {
+    return;
+  }
+  if (session != 0xFF)
+  {
+    uint8_t slot = session < STACK_MAX_STATES ? session : STACK_MAX_STATES - 1;
+    uint16_t depth = stackDepth();
+    if (depth > deepest[slot])
+    {
+      deepest[slot] = depth;
+    }
+    report(slot, depth);
+  }
+  session = state;
+  stackPaint();
+}
+#endif
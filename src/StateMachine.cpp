@@ -0,0 +1,64 @@
+#include "StateMachine.h"
+
+static const State *states = 0;
+static uint8_t current = 0;
+static bool updatePending = false;
+
+void smBegin(const State *table, uint8_t first)
+{
+  states = table;
+  current = first;
+  updatePending = states[current].update != 0;
+  if (states[current].enter)
+  {
+    states[current].enter();
+  }
+}
+
+void smGoto(uint8_t state)
+{
+  if (states[current].exit)
+  {
+    states[current].exit();
+  }
+  current = state;
+  updatePending = states[current].update != 0;
+  if (states[current].enter)
+  {
+    states[current].enter();
+  }
+}
+
+void smDispatch(uint8_t button)
+{
+  if (states[current].event)
+  {
+    states[current].event(button);
+    // The handler may have started an animation or changed state
+    updatePending = states[current].update != 0;
+  }
+}
+
+void smUpdate()
+{
+  if (updatePending)
+  {
+    uint8_t state = current;
+    bool more = states[current].update();
+    // A transition made by update() already decided for the new state
+    if (current == state)
+    {
+      updatePending = more;
+    }
+  }
+}
+
+bool smIdle()
+{
+  return !updatePending;
+}
+
+uint8_t smState()
+{
+  return current;
+}
@@ -0,0 +1,93 @@
+#include "Telemetry.h"
+
+#ifdef TELEMETRY
+
+#include "Hal.h"
+#include "Stack.h"
+
+static uint8_t packet[TELEMETRY_PACKET_SIZE];
+static uint8_t sequence = 0;
+static uint16_t frameStart = 0;
+static bool busy = false;
+static uint16_t sections[TELEMETRY_SECTIONS];
+static uint16_t lcdBytes = 0;
+static uint8_t lateTicks = 0;
+
+static void put16(uint8_t offset, uint16_t value)
+{
+  packet[offset] = value;
+  packet[offset + 1] = value >> 8;
+}
+
+void telemetryBegin()
+{
+  halSerialBegin(TELEMETRY_BAUD);
+  halTimerBegin();
+  stackPaint();
+}
+
+uint16_t telemetryTime()
+{
+  return halTimer();
+}
+
+void telemetryAdd(uint8_t section, uint16_t since)
+{
+  sections[section] += halTimer() - since;
+  busy = true;
+}
+
+void telemetryFlush(uint16_t since, uint16_t bytes)
+{
+  telemetryAdd(TELEMETRY_FLUSH, since);
+  lcdBytes += bytes;
+}
+
+void telemetryLate(uint8_t ticks)
+{
+  lateTicks += ticks;
+}
+
+void telemetryFrameBegin()
+{
+  frameStart = halTimer();
+}
+
+void telemetryFrameEnd(uint8_t state)
+{
+  if (!busy)
+  {
+    return;
+  }
+  uint16_t frame = halTimer() - frameStart;
+
+  packet[0] = 0xA5;
+  packet[1] = 0x5A;
+  packet[2] = sequence++;
+  packet[3] = state;
+  put16(4, halMillis());
+  put16(6, frame);
+  for (uint8_t i = 0; i < TELEMETRY_SECTIONS; ++i)
+  {
+    put16(8 + 2 * i, sections[i]);
+    sections[i] = 0;
+  }
+  put16(16, lcdBytes);
+  put16(18, stackFree());
+  // Scanning the paint is not part of the frame
+  put16(20, stackFreeMin());
+  packet[22] = lateTicks;
+  uint8_t sum = 0;
+  for (uint8_t i = 2; i < TELEMETRY_PACKET_SIZE - 1; ++i)
+  {
+    sum += packet[i];
+  }
+  packet[TELEMETRY_PACKET_SIZE - 1] = sum;
+  halSerialWrite(packet, TELEMETRY_PACKET_SIZE);
+
+  lcdBytes = 0;
+  lateTicks = 0;
+  busy = false;
+}
+
+#endif
@@ -21,876 +21,334 @@ System connection:
 
 */
 
-#include "Arduino.h"
-#include <LiquidCrystal_I2C.h>
-LiquidCrystal_I2C lcd(0x27, 20, 4);
-
-// Button definitions
-#define ButtonYellow 2
-#define ButtonGreen 4
-#define ButtonRed 3
-#define ButtonBlue 5
-
-/*--------- Marks---------*/
-// lcd claer mark
-int mark_clear_lcd = 0;
-
-// start quizz mark
-volatile int S1_Quizz_Start;
-
-// main mark
-volatile uint8_t S1 = 0;
-volatile uint8_t S2 = 0;
-volatile uint8_t S3 = 0;
-volatile uint8_t S4 = 0;
-
-// Button Flags
-volatile bool pushButtonRed = false;
-volatile bool pushButtonYellow = false;
-
-/*---------- First game setup----------*/
-
-#define SPRITE_RUN1 1
-#define SPRITE_RUN2 2
-#define SPRITE_JUMP 3
-#define SPRITE_JUMP_UPPER '.' // Use the '.' character for the head
-#define SPRITE_JUMP_LOWER 4
-#define SPRITE_TERRAIN_EMPTY ' ' // User the ' ' character
-#define SPRITE_TERRAIN_SOLID 5
-#define SPRITE_TERRAIN_SOLID_RIGHT 6
-#define SPRITE_TERRAIN_SOLID_LEFT 7
-int Speed = 150;
-int Tick = 0;
-int Level = 0;
-int Stage = 0;
-int HighScore = 0;
-#define HERO_HORIZONTAL_POSITION 1 // Horizontal position of hero on screen
-
-#define TERRAIN_WIDTH 20
-#define TERRAIN_EMPTY 0
-#define TERRAIN_LOWER_BLOCK 1
-#define TERRAIN_UPPER_BLOCK 2
-
-#define HERO_POSITION_OFF 0         // Hero is invisible
-#define HERO_POSITION_RUN_LOWER_1 1 // Hero is running on lower row (pose 1)
-#define HERO_POSITION_RUN_LOWER_2 2 //                              (pose 2)
-
-#define HERO_POSITION_JUMP_1 3       // Starting a jump
-#define HERO_POSITION_JUMP_2 4       // Half-way up
-#define HERO_POSITION_JUMP_3 5       // Jump is on upper row
-#define HERO_POSITION_JUMP_4 6       // Jump is on upper row
-#define HERO_POSITION_JUMP_5 7       // Jump is on upper row
-#define HERO_POSITION_JUMP_6 8       // Jump is on upper row
-#define HERO_POSITION_JUMP_7 9       // Half-way down
-#define HERO_POSITION_JUMP_8 10      // About to land
-#define HERO_POSITION_RUN_UPPER_1 11 // Hero is running on upper row (pose 1)
-#define HERO_POSITION_RUN_UPPER_2 12 //                              (pose 2)
-
-static char terrainUpper[TERRAIN_WIDTH + 1];
-static char terrainLower[TERRAIN_WIDTH + 1];
-
-void initializeGraphics()
+#include "Hal.h"
+#include "FrameBuffer.h"
+#include "Game.h"
+#include "Input.h"
+#include "Latency.h"
+#include "Persist.h"
+#include "Power.h"
+#include "Rbr.h"
+#include "Replay.h"
+#include "Rng.h"
+#include "Stack.h"
+#include "StateMachine.h"
+#include "Telemetry.h"
+
+/*--------- States---------*/
+#define STATE_SPLASH 0
+#define STATE_MENU 1
+#define STATE_GAME 2 // One per game module, in registry order
+
+#define SPLASH_TIME 500
+
+// Loaded from EEPROM at power-on, saved after every RBR run
+PersistData settings = {0, 0, RBR_START_SPEED, POWER_BACKLIGHT_TIMEOUT};
+
+/*------------ Splash screen ------------*/
+static uint32_t stateTimer;
+
+static void splashEnter()
 {
-  static byte graphics[] = {
-      // Run position 1
-      B01100,
-      B01100,
-      B00000,
-      B01110,
-      B11100,
-      B01100,
-      B11010,
-      B10011,
-      // Run position 2
-      B01100,
-      B01100,
-      B00000,
-      B01100,
-      B01100,
-      B01100,
-      B01100,
-      B01110,
-      // Jump
-      B01100,
-      B01100,
-      B00000,
-      B11110,
-      B01101,
-      B11111,
-      B10000,
-      B00000,
-      // Jump lower
-      B11110,
-      B01101,
-      B11111,
-      B10000,
-      B00000,
-      B00000,
-      B00000,
-      B00000,
-      // Ground
-      B11111,
-      B11111,
-      B11111,
-      B11111,
-      B11111,
-      B11111,
-      B11111,
-      B11111,
-      // Ground right
-      B00011,
-      B00011,
-      B00011,
-      B00011,
-      B00011,
-      B00011,
-      B00011,
-      B00011,
-      // Ground left
-      B11000,
-      B11000,
-      B11000,
-      B11000,
-      B11000,
-      B11000,
-      B11000,
-      B11000,
-  };
-  int i;
-  for (i = 0; i < 7; ++i)
-  {
-    lcd.createChar(i + 1, &graphics[i * 8]);
-  }
-  for (i = 0; i < TERRAIN_WIDTH; ++i)
-  {
-    terrainUpper[i] = SPRITE_TERRAIN_EMPTY;
-    terrainLower[i] = SPRITE_TERRAIN_EMPTY;
-  }
+  fb.clear();
+#if DISPLAY_ROWS >= 4
+  FB_TEXT(6, 0, "Project:");
+  FB_TEXT(2, 1, "G A M E   B O Y");
+  FB_TEXT(7, 2, "Author:");
+  FB_TEXT(2, 3, "Michal Blotniak");
+#else
+  FB_TEXT(0, 0, "G A M E   B O Y");
+  FB_TEXT(0, 1, "Michal Blotniak");
+#endif
+  stateTimer = halMillis();
 }
-void advanceTerrain(char *terrain, byte newTerrain)
+
+static bool splashUpdate()
 {
-  for (int i = 0; i < TERRAIN_WIDTH; ++i)
+  if (halMillis() - stateTimer >= SPLASH_TIME)
   {
-    char current = terrain[i];
-    char next = (i == TERRAIN_WIDTH - 1) ? newTerrain : terrain[i + 1];
-    switch (current)
-    {
-    case SPRITE_TERRAIN_EMPTY:
-      terrain[i] = (next == SPRITE_TERRAIN_SOLID) ? SPRITE_TERRAIN_SOLID_RIGHT : SPRITE_TERRAIN_EMPTY;
-      break;
-    case SPRITE_TERRAIN_SOLID:
-      terrain[i] = (next == SPRITE_TERRAIN_EMPTY) ? SPRITE_TERRAIN_SOLID_LEFT : SPRITE_TERRAIN_SOLID;
-      break;
-    case SPRITE_TERRAIN_SOLID_RIGHT:
-      terrain[i] = SPRITE_TERRAIN_SOLID;
-      break;
-    case SPRITE_TERRAIN_SOLID_LEFT:
-      terrain[i] = SPRITE_TERRAIN_EMPTY;
-      break;
-    }
+    smGoto(STATE_MENU);
   }
+  return true;
 }
 
-bool drawHero(byte position, char *terrainUpper, char *terrainLower, unsigned int score)
+/*------------ Menu ------------*/
+// The games of the registry get these buttons in order
+static const uint8_t menuButtons[GAME_MAX_MODULES] = {ButtonYellow, ButtonGreen, ButtonRed};
+
+#if DISPLAY_ROWS >= 4
+// A title, then one "name -> button" row per game
+static const char *const menuButtonNames[GAME_MAX_MODULES] = {"YellowBT", "GreenBT", "RedBT"};
+#define MENU_BUTTON_COLUMN 8
+static_assert(Display::fits(2, GAME_MAX_MODULES, GAME_NAME_LENGTH) &&
+                  Display::fits(MENU_BUTTON_COLUMN, GAME_MAX_MODULES, 3 + 8),
+              "a menu row per game");
+#else
+// "Y name" entries, two per row
+static const char menuButtonLetters[GAME_MAX_MODULES] = {'Y', 'G', 'R'};
+#define MENU_ENTRY_WIDTH (Display::cols / 2)
+static_assert(GAME_MAX_MODULES <= 2 * Display::rows && 2 + GAME_NAME_LENGTH <= MENU_ENTRY_WIDTH,
+              "two menu entries per row");
+#endif
+
+static void menuEnter()
 {
-  bool collide = false;
-  char upperSave = terrainUpper[HERO_HORIZONTAL_POSITION];
-  char lowerSave = terrainLower[HERO_HORIZONTAL_POSITION];
-  byte upper, lower;
-  switch (position)
+  fb.clear();
+#if DISPLAY_ROWS >= 4
+  FB_TEXT(4, 0, "Select game:");
+  for (uint8_t i = 0; i < gameCount(); ++i)
   {
-  case HERO_POSITION_OFF:
-    upper = lower = SPRITE_TERRAIN_EMPTY;
-    break;
-  case HERO_POSITION_RUN_LOWER_1:
-    upper = SPRITE_TERRAIN_EMPTY;
-    lower = SPRITE_RUN1;
-    break;
-  case HERO_POSITION_RUN_LOWER_2:
-    upper = SPRITE_TERRAIN_EMPTY;
-    lower = SPRITE_RUN2;
-    break;
-  case HERO_POSITION_JUMP_1:
-  case HERO_POSITION_JUMP_8:
-    upper = SPRITE_TERRAIN_EMPTY;
-    lower = SPRITE_JUMP;
-    break;
-  case HERO_POSITION_JUMP_2:
-  case HERO_POSITION_JUMP_7:
-    upper = SPRITE_JUMP_UPPER;
-    lower = SPRITE_JUMP_LOWER;
-    break;
-  case HERO_POSITION_JUMP_3:
-  case HERO_POSITION_JUMP_4:
-  case HERO_POSITION_JUMP_5:
-  case HERO_POSITION_JUMP_6:
-    upper = SPRITE_JUMP;
-    lower = SPRITE_TERRAIN_EMPTY;
-    break;
-  case HERO_POSITION_RUN_UPPER_1:
-    upper = SPRITE_RUN1;
-    lower = SPRITE_TERRAIN_EMPTY;
-    break;
-  case HERO_POSITION_RUN_UPPER_2:
-    upper = SPRITE_RUN2;
-    lower = SPRITE_TERRAIN_EMPTY;
-    break;
+    fb.setCursor(2, 1 + i);
+    fb.print(FPSTR(gameModule(i)->name));
+    fb.setCursor(MENU_BUTTON_COLUMN, 1 + i);
+    fb.print("-> ");
+    fb.print(menuButtonNames[i]);
   }
-  if (upper != ' ')
+#else
+  for (uint8_t i = 0; i < gameCount(); ++i)
   {
-    terrainUpper[HERO_HORIZONTAL_POSITION] = upper;
-    collide = (upperSave == SPRITE_TERRAIN_EMPTY) ? false : true;
+    fb.setCursor((i & 1) * MENU_ENTRY_WIDTH, i >> 1);
+    fb.write(menuButtonLetters[i]);
+    fb.write(' ');
+    fb.print(FPSTR(gameModule(i)->name));
   }
-  if (lower != ' ')
-  {
-    terrainLower[HERO_HORIZONTAL_POSITION] = lower;
-    collide |= (lowerSave == SPRITE_TERRAIN_EMPTY) ? false : true;
-  }
-  byte digits = (score > 9999) ? 5 : (score > 999) ? 4
-                                 : (score > 99)    ? 3
-                                 : (score > 9)     ? 2
-                                                   : 1;
-
-  // Draw the scene
-  terrainUpper[TERRAIN_WIDTH] = '\0';
-  terrainLower[TERRAIN_WIDTH] = '\0';
-  char temp = terrainUpper[16 - digits];
-  terrainUpper[16 - digits] = '\0';
-  lcd.setCursor(0, 0);
-  lcd.print(terrainUpper);
-  terrainUpper[16 - digits] = temp;
-  lcd.setCursor(0, 1);
-  lcd.print(terrainLower);
-  lcd.setCursor(0, 3);
-  lcd.print("Dist ");
-  lcd.setCursor(6, 3);
-  lcd.print(score);
-  if (Stage == 25)
+#endif
+}
+
+static void menuEvent(uint8_t button)
+{
+  for (uint8_t i = 0; i < gameCount(); ++i)
   {
-    Stage = 0;
-    Level++;
-    Speed--;
+    if (button == menuButtons[i])
+      smGoto(STATE_GAME + i);
   }
-  lcd.setCursor(0, 2);
-  lcd.print("Score");
-  lcd.setCursor(6, 2);
-  lcd.print(Level);
-  terrainUpper[HERO_HORIZONTAL_POSITION] = upperSave;
-  terrainLower[HERO_HORIZONTAL_POSITION] = lowerSave;
-  return collide;
 }
 
-/*---------- End first game setup----------*/
-
-// Interrupt functions
-void ButtonYellowPush()
+/*------------ Games ------------*/
+static void gameEnter()
 {
-  pushButtonYellow = true;
+  gameStart(gameModule(smState() - STATE_GAME));
 }
-void ButtonRedPush()
+
+static bool gameStateUpdate()
 {
-  pushButtonRed = true;
+  uint8_t result = gameUpdate();
+  if (result & GAME_EXIT)
+  {
+    smGoto(STATE_MENU);
+    return false;
+  }
+  return result & GAME_ANIMATE;
 }
 
-// Set up project
-void setup()
+/*--------------- RNG timing -------------*/
+#if defined(RNG_BENCH) && defined(ARDUINO)
+#define RNG_BENCH_CALLS 100
+
+// Timer 1 counts of RNG_BENCH_CALLS calls, 64 CPU cycles per count
+static uint16_t benchArduino(long max)
 {
-  // lcd display setup
-  lcd.init();
-  lcd.backlight();
-
-  // button set up
-  pinMode(ButtonYellow, INPUT);
-  pinMode(ButtonRed, OUTPUT);
-  pinMode(ButtonGreen, INPUT_PULLUP);
-  pinMode(ButtonBlue, INPUT_PULLUP);
-
-  digitalWrite(ButtonRed, HIGH);
-  digitalWrite(ButtonYellow, HIGH);
-
-  // Interrupts setup
-  attachInterrupt(0, ButtonYellowPush, FALLING);
-  attachInterrupt(ButtonRed, ButtonRedPush, FALLING);
-
-  // Info display
-  lcd.setCursor(6, 0);
-  lcd.print("Project:");
-  lcd.setCursor(2, 1);
-  lcd.print("G A M E   B O Y");
-  lcd.setCursor(7, 2);
-  lcd.print("Author:");
-  lcd.setCursor(2, 3);
-  lcd.print("Michal Blotniak");
-  delay(500);
-  lcd.clear();
-  S1 = 1;
+  volatile long sink;
+  uint16_t start = halTimer();
+  for (uint8_t i = 0; i < RNG_BENCH_CALLS; ++i)
+    sink = random(max);
+  (void)sink;
+  return halTimer() - start;
 }
 
-// Main loop
-void loop()
+static uint16_t benchRng(Rng &rng, uint8_t max)
 {
+  volatile uint8_t sink;
+  uint16_t start = halTimer();
+  for (uint8_t i = 0; i < RNG_BENCH_CALLS; ++i)
+    sink = rngBelow(rng, max);
+  (void)sink;
+  return halTimer() - start;
+}
 
-  while (S1 == 1)
-  {
-    if (mark_clear_lcd == 1)
-    {
-      lcd.clear();
-      mark_clear_lcd = 0;
-    }
-
-    lcd.setCursor(4, 0);
-    lcd.print("Select game:");
-    lcd.setCursor(2, 1);
-    lcd.print("RBR  -> YellowBT");
-    lcd.setCursor(1, 2);
-    lcd.print("Quizz -> GreenBT");
-    lcd.setCursor(1, 3);
-    lcd.print("Home->Bl");
-    lcd.setCursor(11, 3);
-    lcd.print("Info->Rd");
-
-    if (digitalRead(ButtonYellow) == LOW)
-    {
-      lcd.clear();
-      S1 = 0;
-      S2 = 0;
-      S3 = 1;
-      S4 = 0;
-    }
-    if (digitalRead(ButtonGreen) == LOW)
-    {
-      lcd.clear();
-      S1 = 0;
-      S2 = 0;
-      S3 = 0;
-      S4 = 1;
-      S1_Quizz_Start = 1;
-    }
-    if (digitalRead(ButtonRed) == LOW)
-    {
-      lcd.clear();
-      S1 = 0;
-      S2 = 1;
-      S3 = 0;
-      S4 = 0;
-    }
-  }
-
-  /*------------ Info display ------------*/
-  while (S2 == 1)
+// Prints cycles per call of random(n) and rngBelow(n) for the terrain's n
+static void rngBench()
+{
+  static const uint8_t ranges[] = {3, 10};
+  Rng rng;
+  rngSeed(rng, 1);
+  halTimerBegin();
+  for (uint8_t i = 0; i < sizeof(ranges); ++i)
   {
-    lcd.setCursor(1, 0);
-    lcd.print("Check my GitHub :)");
-    lcd.setCursor(4, 1);
-    lcd.print("Name: mechasB");
-    lcd.setCursor(4, 2);
-    lcd.print("Repositories:");
-    lcd.setCursor(3, 3);
-    lcd.print("G a m e  B o y");
-
-    // Reset system
-    if (digitalRead(ButtonBlue) == LOW)
-    {
-      lcd.clear();
-      mark_clear_lcd = 1;
-      S1 = 1;
-      S2 = 0;
-      S3 = 0;
-      S4 = 0;
-    }
+    noInterrupts();
+    uint16_t arduino = benchArduino(ranges[i]);
+    uint16_t own = benchRng(rng, ranges[i]);
+    interrupts();
+    halSerialPrint("n=");
+    halSerialPrint(ranges[i]);
+    halSerialPrint(": random() ");
+    halSerialPrint((uint32_t)arduino * 64 / RNG_BENCH_CALLS);
+    halSerialPrint(" cycles, rngBelow() ");
+    halSerialPrint((uint32_t)own * 64 / RNG_BENCH_CALLS);
+    halSerialPrint(" cycles\n");
   }
+}
+#endif
 
-  /*--------------- Game "RBR" -------------*/
-  while (S3 == 1)
-  {
-    static unsigned int distance = 0;
-    // Reset system
-    if (digitalRead(ButtonBlue) == LOW)
-    {
-      lcd.clear();
-      mark_clear_lcd = 1;
-      S1 = 1;
-      S2 = 0;
-      S3 = 0;
-      S4 = 0;
-
-      distance = 0;
-      Level = 0;
-    }
-    static byte heroPos = HERO_POSITION_RUN_LOWER_1;
-    static byte newTerrainType = TERRAIN_EMPTY;
-    static byte newTerrainDuration = 1;
-    static bool playing = false;
-    static bool blink = false;
+#if defined(GPIO_BENCH) && defined(ARDUINO)
+#define GPIO_BENCH_CALLS 200
 
-    if (!playing)
-    {
-      drawHero((blink) ? HERO_POSITION_OFF : heroPos, terrainUpper, terrainLower, distance >> 3);
-      if (blink)
-      {
-        lcd.setCursor(3, 0);
-        lcd.print("Press To Start ");
-        delay(350);
-        lcd.setCursor(3, 0);
-        lcd.print("               ");
-        lcd.setCursor(5, 2);
-        lcd.print("    ");
-        lcd.setCursor(5, 3);
-        lcd.print("    ");
-        Tick++;
-        lcd.setCursor(11, 2);
-        lcd.print("Top Score");
-        lcd.setCursor(15, 3);
-        lcd.print(HighScore);
-        if (Tick == 50)
-        {
-          lcd.noBacklight();
-          Tick = 0;
-        }
-      }
-      delay(150);
-      blink = !blink;
-      if (pushButtonYellow)
-      {
-        initializeGraphics();
-        heroPos = HERO_POSITION_RUN_LOWER_1;
-        playing = true;
-        pushButtonYellow = false;
-        distance = 0;
-        Level = 0;
-        lcd.backlight();
-      }
-      return;
-    }
+// Timer 1 counts of GPIO_BENCH_CALLS runs of op, 64 CPU cycles per count
+template <class Op>
+static uint16_t benchGpio(Op op)
+{
+  uint16_t start = halTimer();
+  for (uint8_t i = 0; i < GPIO_BENCH_CALLS; ++i)
+    op();
+  return halTimer() - start;
+}
 
-    // Shift the terrain to the left
-    advanceTerrain(terrainLower, newTerrainType == TERRAIN_LOWER_BLOCK ? SPRITE_TERRAIN_SOLID : SPRITE_TERRAIN_EMPTY);
-    advanceTerrain(terrainUpper, newTerrainType == TERRAIN_UPPER_BLOCK ? SPRITE_TERRAIN_SOLID : SPRITE_TERRAIN_EMPTY);
+// Cycles per call, without the loop
+static uint32_t gpioCycles(uint16_t counts, uint16_t loop)
+{
+  if (counts < loop)
+    return 0;
+  return ((uint32_t)counts - loop) * 64 / GPIO_BENCH_CALLS;
+}
 
-    // Make new terrain to enter on the right
-    if (--newTerrainDuration == 0)
-    {
-      if (newTerrainType == TERRAIN_EMPTY)
-      {
-        newTerrainType = (random(3) == 0) ? TERRAIN_UPPER_BLOCK : TERRAIN_LOWER_BLOCK;
-        newTerrainDuration = 2 + random(10);
-      }
-      else
-      {
-        newTerrainType = TERRAIN_EMPTY;
-        newTerrainDuration = 10 + random(10);
-      }
-    }
+// Prints cycles per call of the Arduino pin functions and of Pin.h
+static void gpioBench()
+{
+  volatile uint8_t sink;
+  volatile bool level = true;
+  halTimerBegin();
+  noInterrupts();
+  uint16_t loop = benchGpio([&] { sink = 0; });
+  uint16_t arduinoWrite = benchGpio([&] { digitalWrite(ButtonRed, level ? HIGH : LOW); });
+  uint16_t pinWrite = benchGpio([&] { PinRed::write(level); });
+  uint16_t arduinoRead = benchGpio([&] { sink = digitalRead(ButtonGreen); });
+  uint16_t pinRead = benchGpio([&] { sink = PinGreen::read(); });
+  uint16_t arduinoButtons = benchGpio([&] {
+    sink = digitalRead(ButtonYellow) | digitalRead(ButtonGreen) << 1 |
+           digitalRead(ButtonRed) << 2 | digitalRead(ButtonBlue) << 3;
+  });
+  uint16_t pinButtons = benchGpio([&] { sink = PinButtons::read(); });
+  interrupts();
+  halSerialPrint("write: digitalWrite() ");
+  halSerialPrint(gpioCycles(arduinoWrite, loop));
+  halSerialPrint(" cycles, Pin ");
+  halSerialPrint(gpioCycles(pinWrite, loop));
+  halSerialPrint(" cycles\nread: digitalRead() ");
+  halSerialPrint(gpioCycles(arduinoRead, loop));
+  halSerialPrint(" cycles, Pin ");
+  halSerialPrint(gpioCycles(pinRead, loop));
+  halSerialPrint(" cycles\n4 buttons: digitalRead() ");
+  halSerialPrint(gpioCycles(arduinoButtons, loop));
+  halSerialPrint(" cycles, PinGroup ");
+  halSerialPrint(gpioCycles(pinButtons, loop));
+  halSerialPrint(" cycles\n");
+}
+#endif
+
+/*--------------- States -------------*/
+#define GAME_STATE {gameEnter, gameEvent, gameStateUpdate, gameStop}
+static const State states[] = {
+    // enter, event, update, exit
+    {splashEnter, 0, splashUpdate, 0},
+    {menuEnter, menuEvent, 0, 0},
+    GAME_STATE,
+    GAME_STATE,
+    GAME_STATE,
+};
+static_assert(sizeof(states) / sizeof(states[0]) == STATE_GAME + GAME_MAX_MODULES, "a state for every game");
+
+static void buttonPressed(uint8_t button)
+{
+  // A press on a dark display only wakes it up
+  if (!powerActivity())
+    return;
+  // Blue is "home" everywhere past the menu
+  if (button == ButtonBlue && smState() > STATE_MENU)
+    smGoto(STATE_MENU);
+  else
+    smDispatch(button);
+}
 
-    if (pushButtonYellow)
-    {
-      if (heroPos <= HERO_POSITION_RUN_LOWER_2)
-        heroPos = HERO_POSITION_JUMP_1;
-      pushButtonYellow = false;
-    }
+// A dropped bounce is waiting for its debounce window to end
+static bool settling = false;
 
-    if (drawHero(heroPos, terrainUpper, terrainLower, distance >> 3))
-    {
-      playing = false; // The hero collided with something. Too bad.
-    }
-    else
+static void pollButtons()
+{
+  InputEvent event;
+  uint16_t start = telemetryTime();
+  bool handled = false;
+  settling = inputUpdate();
+  while (inputPop(event))
+  {
+    rngStir(event.time);
+    if (event.pressed)
     {
-      if (heroPos == HERO_POSITION_RUN_LOWER_2 || heroPos == HERO_POSITION_JUMP_8)
-      {
-        heroPos = HERO_POSITION_RUN_LOWER_1;
-      }
-      else if ((heroPos >= HERO_POSITION_JUMP_3 && heroPos <= HERO_POSITION_JUMP_5) && terrainLower[HERO_HORIZONTAL_POSITION] != SPRITE_TERRAIN_EMPTY)
-      {
-        heroPos = HERO_POSITION_RUN_UPPER_1;
-      }
-      else if (heroPos >= HERO_POSITION_RUN_UPPER_1 && terrainLower[HERO_HORIZONTAL_POSITION] == SPRITE_TERRAIN_EMPTY)
-      {
-        heroPos = HERO_POSITION_JUMP_5;
-      }
-      else if (heroPos == HERO_POSITION_RUN_UPPER_2)
-      {
-        heroPos = HERO_POSITION_RUN_UPPER_1;
-      }
-      else
-      {
-        ++heroPos;
-      }
-      ++distance;
-      Stage++;
-      if (Level > HighScore)
-      {
-        HighScore = Level;
-      }
-      lcd.setCursor(11, 2);
-      lcd.print("Top Score");
-      lcd.setCursor(15, 3);
-      lcd.print(HighScore);
-      digitalWrite(ButtonRed, terrainLower[HERO_HORIZONTAL_POSITION + 2] == SPRITE_TERRAIN_EMPTY ? HIGH : LOW);
+      latencyPress(event.button, event.time);
+      buttonPressed(event.button);
     }
-    delay(Speed);
+    handled = true;
   }
-
-  /*--------------- End Game "RBR" -------------*/
-
-  /*--------------- Game "Quizz" -------------*/
-
-  while (S4 == 1)
+  if (handled)
   {
+    telemetryAdd(TELEMETRY_INPUT, start);
+  }
+}
 
-    /*--------------------Set Quizz--------------------*/
-    // Marks
-
-    uint8_t S_End_Quizz = 0;   // lose mark
-    uint8_t S_Finish_Game = 0; // end game mark
-    uint8_t S1_Quizz = 0;
-    uint8_t S2_Quizz = 0;
-    uint8_t S3_Quizz = 0;
-    uint8_t S4_Quizz = 0;
-    uint8_t S5_Quizz = 0;
-    uint8_t S6_Quizz = 0;
-    uint8_t S7_Quizz = 0;
-    uint8_t S8_Quizz = 0;
-    uint8_t S9_Quizz = 0;
-    uint8_t S10_Quizz = 0;
-
-    /*-------------Reset system--------------*/
-    if (digitalRead(ButtonBlue) == LOW)
-    {
-      lcd.clear();
-      mark_clear_lcd = 1;
-      S1 = 1;
-      S2 = 0;
-      S3 = 0;
-      S4 = 0;
-      S1_Quizz_Start = 0;
-      S_End_Quizz = 0;
-      S1_Quizz = 0;
-      S2_Quizz = 0;
-      S3_Quizz = 0;
-      S4_Quizz = 0;
-      S5_Quizz = 0;
-      S6_Quizz = 0;
-      S7_Quizz = 0;
-      S8_Quizz = 0;
-      S9_Quizz = 0;
-      S10_Quizz = 0;
-    }
-
-    /*--------End display----------*/
-    while (S_End_Quizz == 1)
-    {
-      lcd.setCursor(4, 0);
-      lcd.print("?  Quizz  ?");
-      lcd.setCursor(3, 1);
-      lcd.print("Bad answer :/");
-      lcd.setCursor(0, 2);
-      lcd.print("Play again  Go home");
-      lcd.setCursor(0, 3);
-      lcd.print("  <---       --->  ");
-
-      if (pushButtonYellow)
-      {
-        S1_Quizz_Start = 1;
-        S_End_Quizz = 0;
-        S1_Quizz = 0;
-        S2_Quizz = 0;
-        S3_Quizz = 0;
-        S4_Quizz = 0;
-        S5_Quizz = 0;
-        S6_Quizz = 0;
-        S7_Quizz = 0;
-        S8_Quizz = 0;
-        S9_Quizz = 0;
-        S10_Quizz = 0;
-      }
-      if (digitalRead(ButtonBlue) == LOW)
-      {
-        lcd.clear();
-        mark_clear_lcd = 1;
-        S1 = 1;
-        S2 = 0;
-        S3 = 0;
-        S4 = 0;
-      }
-    }
-
-    /*---------- Finish display----------*/
-    while (S_Finish_Game == 1)
-    {
-      lcd.setCursor(1, 1);
-      lcd.print("Congratulations !");
-      lcd.setCursor(2, 2);
-      lcd.print("You know a lot ");
-      lcd.setCursor(2, 3);
-      lcd.print("about arduino ;)");
-      delay(5000);
-      lcd.clear();
-      S_Finish_Game = 0;
-      S1 = 1;
-    }
-
-    /*--------------------Brain Quizz--------------------*/
-
-    while (S1_Quizz_Start == 1)
-    {
-      lcd.setCursor(4, 0);
-      lcd.print("?  Quizz  ?");
-      lcd.setCursor(0, 1);
-      lcd.print(" Select the correct ");
-      lcd.setCursor(0, 2);
-      lcd.print("answer using the bt");
-      lcd.setCursor(0, 3);
-      lcd.print("<- Lf_ans   Rg_ans->");
-      delay(3000);
-      lcd.clear();
-      S1_Quizz_Start = 0;
-      S1_Quizz = 1;
-    }
-
-    // first question
-    while (S1_Quizz == 1)
-    {
-      lcd.setCursor(3, 0);
-      lcd.print("What is blink:");
-      lcd.setCursor(0, 2);
-      lcd.print("<--  blinking LED");
-      lcd.setCursor(2, 3);
-      lcd.print("IDE for Arduino-->");
-      if (pushButtonRed)
-      {
-        lcd.clear();
-        S2_Quizz = 1;
-        S1_Quizz = 0;
-      }
-      if (pushButtonYellow)
-      {
-        lcd.clear();
-        S_End_Quizz = 1;
-        S1_Quizz = 0;
-      }
-    }
-
-    // second question
-    while (S2_Quizz == 1)
-    {
-      lcd.setCursor(0, 0);
-      lcd.print(" Where the Arduino ");
-      lcd.setCursor(2, 1);
-      lcd.print("was constructed ?");
-      lcd.setCursor(3, 3);
-      lcd.print("<- In Italy");
-      lcd.setCursor(5, 3);
-      lcd.print("In USA ->");
-      if (pushButtonRed)
-      {
-        lcd.clear();
-        S2_Quizz = 0;
-        S3_Quizz = 1;
-      }
-      if (pushButtonYellow)
-      {
-        lcd.clear();
-        S2_Quizz = 0;
-        S_End_Quizz = 1;
-      }
-    }
-
-    // third question
-    while (S3_Quizz == 1)
-    {
-      lcd.setCursor(0, 0);
-      lcd.print("What language do we");
-      lcd.setCursor(1, 1);
-      lcd.print("program arduino in?");
-      lcd.setCursor(0, 2);
-      lcd.print("<- HTML");
-      lcd.setCursor(13, 3);
-      lcd.print("C++ ->");
-      if (pushButtonRed)
-      {
-        lcd.clear();
-        S3_Quizz = 0;
-        S_End_Quizz = 1;
-      }
-      if (pushButtonYellow)
-      {
-        lcd.clear();
-        S3_Quizz = 0;
-        S4_Quizz = 1;
-      }
-    }
-
-    // fourth question
-    while (S4_Quizz == 1)
-    {
-      lcd.setCursor(0, 0);
-      lcd.print(" When was the C ? ");
-      lcd.setCursor(3, 3);
-      lcd.print("<- 1972");
-      lcd.setCursor(5, 3);
-      lcd.print("2000 ->");
-      if (pushButtonRed)
-      {
-        lcd.clear();
-        S4_Quizz = 0;
-        S5_Quizz = 1;
-      }
-      if (pushButtonYellow)
-      {
-        lcd.clear();
-        S4_Quizz = 0;
-        S_End_Quizz = 1;
-      }
-    }
-
-    // fifth question
-    while (S5_Quizz == 1)
-    {
-      lcd.setCursor(0, 0);
-      lcd.print("What is && in C++ ?");
-      lcd.setCursor(0, 2);
-      lcd.print("<- Product (AND)");
-      lcd.setCursor(6, 3);
-      lcd.print("Sum (OR) ->");
-      if (pushButtonRed)
-      {
-        lcd.clear();
-        S5_Quizz = 0;
-        S_End_Quizz = 1;
-      }
-      if (pushButtonYellow)
-      {
-        lcd.clear();
-        S5_Quizz = 0;
-        S6_Quizz = 1;
-      }
-    }
-
-    // sixth question
-    while (S6_Quizz == 1)
-    {
-      lcd.setCursor(0, 0);
-      lcd.print("What processors are");
-      lcd.setCursor(4, 1);
-      lcd.print("in Arduino ?");
-      lcd.setCursor(0, 2);
-      lcd.print("<-- STM8");
-      lcd.setCursor(7, 3);
-      lcd.print("Atmel AVR-->");
-      if (pushButtonYellow)
-      {
-        lcd.clear();
-        S6_Quizz = 1;
-        S7_Quizz = 0;
-      }
-      if (pushButtonRed)
-      {
-        lcd.clear();
-        S_End_Quizz = 1;
-        S7_Quizz = 0;
-      }
-    }
-
-    // seventh question
-    while (S7_Quizz == 1)
-    {
-      lcd.setCursor(0, 0);
-      lcd.print(" Who is the author ");
-      lcd.setCursor(4, 1);
-      lcd.print("of arduino ?");
-      lcd.setCursor(0, 2);
-      lcd.print("<- Massimo Banzi");
-      lcd.setCursor(7, 3);
-      lcd.print("Bill Gates ->");
-      if (pushButtonRed)
-      {
-        lcd.clear();
-        S7_Quizz = 0;
-        S8_Quizz = 1;
-      }
-      if (pushButtonYellow)
-      {
-        lcd.clear();
-        S8_Quizz = 0;
-        S_End_Quizz = 1;
-      }
-    }
-
-    // eighth question
-    while (S8_Quizz == 1)
-    {
-      lcd.setCursor(5, 0);
-      lcd.print("What year was");
-      lcd.setCursor(1, 1);
-      lcd.print("the arduino made?");
-      lcd.setCursor(0, 2);
-      lcd.print("<- 2005");
-      lcd.setCursor(12, 3);
-      lcd.print("1999 ->");
-      if (pushButtonYellow)
-      {
-        lcd.clear();
-        S8_Quizz = 0;
-        S_End_Quizz = 1;
-      }
-      if (pushButtonRed)
-      {
-        lcd.clear();
-        S8_Quizz = 0;
-        S9_Quizz = 1;
-      }
-    }
-
-    // ninth question
-    while (S9_Quizz == 1)
-    {
-      lcd.setCursor(1, 0);
-      lcd.print("For whom arduino");
-      lcd.setCursor(5, 1);
-      lcd.print("was made ?");
-      lcd.setCursor(0, 3);
-      lcd.print("<- For developers");
-      lcd.setCursor(4, 3);
-      lcd.print("For students ->");
-      if (pushButtonYellow)
-      {
-        lcd.clear();
-        S9_Quizz = 0;
-        S10_Quizz = 1;
-      }
-      if (pushButtonRed)
-      {
-        lcd.clear();
-        S4_Quizz = 0;
-        S_End_Quizz = 1;
-      }
-    }
-
-    // tenth question
-    while (S10_Quizz == 1)
-    {
-      lcd.setCursor(1, 0);
-      lcd.print("How many versions");
-      lcd.setCursor(1, 1);
-      lcd.print("of ard are there?");
-      lcd.setCursor(0, 2);
-      lcd.print("<- 34");
-      lcd.setCursor(14, 3);
-      lcd.print("12 ->");
-      if (pushButtonYellow)
-      {
-        lcd.clear();
-        S10_Quizz = 0;
-        S_End_Quizz = 1;
-      }
-      if (pushButtonRed)
-      {
-        lcd.clear();
-        S10_Quizz = 0;
-        S_Finish_Game = 1;
-      }
-    }
+// Set up project
+void setup()
+{
+  // lcd display setup
+  halDisplayInit();
+  halDisplayBacklight(true);
+
+#if defined(FB_STATS) || defined(REPLAY_SERIAL) || defined(RNG_BENCH) || defined(GPIO_BENCH) || defined(STACK_MONITOR) || defined(LATENCY)
+  // LCD bytes per RBR frame, transport chars/ms, RBR recordings, the RNG
+  // and GPIO timings, the stack depths and the input latency are printed
+  // here
+  halSerialBegin(115200);
+#endif
+#if defined(RNG_BENCH) && defined(ARDUINO)
+  rngBench();
+#endif
+  // Seeds the first game even before any button was pressed
+  rngStir(halEntropy());
+
+  // Top score and settings of the last session, and its last RBR run
+  persistBegin(settings);
+  replayBegin();
+  RbrCarry carry = {settings.startSpeed, 0, settings.highScore};
+  rbrLoadCarry(carry);
+
+  // button and interrupts set up
+  inputBegin();
+#if defined(GPIO_BENCH) && defined(ARDUINO)
+  // The buttons' pins are configured now, Red is left high (LED off)
+  gpioBench();
+#endif
+
+  powerBegin();
+  powerSetTimeouts(settings.backlight, POWER_DISPLAY_TIMEOUT);
+  // Takes over Serial at TELEMETRY_BAUD
+  telemetryBegin();
+  smBegin(states, STATE_SPLASH);
+  fb.flush();
+}
 
-    /*--------------------End Brain Quizz--------------------*/
+// Main loop
+void loop()
+{
+  telemetryFrameBegin();
+  pollButtons();
+  // Nothing to animate while the display is off
+  if (powerDisplayOn())
+  {
+    smUpdate();
+    // Idle states leave the frame buffer clean, so this sends nothing
+    fb.flush();
   }
-}
\ No newline at end of file
+  telemetryFrameEnd(smState());
+  latencyUpdate();
+  stackMonitor(smState());
+  // Timer 0 keeps the loop coming back until the buttons have settled
+  powerIdle(smState(), !smIdle() || settling);
+}
@@ -0,0 +1,189 @@
+#include "Bots.h"
+#include <stdio.h>
+
+// Next position for every jump hang, terrain in the hero column, position
+// and jump; -1 is a collision
+static int8_t transitions[RBR_JUMP_HANG_MAX][4][HERO_POSITIONS][2];
+
+static void buildTransitions()
+{
+  static bool built = false;
+  if (built)
+    return;
+  for (uint8_t hang = 1; hang <= RBR_JUMP_HANG_MAX; ++hang)
+  {
+    for (uint8_t column = 0; column < 4; ++column)
+    {
+      for (uint8_t hero = 0; hero < HERO_POSITIONS; ++hero)
+      {
+        for (uint8_t jump = 0; jump < 2; ++jump)
+        {
+          uint8_t pose = rbrHeroJump(hero, jump);
+          bool upperSolid = column & 1;
+          bool lowerSolid = column & 2;
+          transitions[hang - 1][column][hero][jump] =
+              rbrHeroCollides(pose, upperSolid, lowerSolid) ? -1 : rbrHeroNext(pose, lowerSolid, hang);
+        }
+      }
+    }
+  }
+  built = true;
+}
+
+static uint8_t heroColumn(const RbrGame &game)
+{
+  return terrainSolid(game.upper, RBR_HERO_COLUMN) | (terrainSolid(game.lower, RBR_HERO_COLUMN) << 1);
+}
+
+PerfectBot::PerfectBot(uint32_t cap) : cap(cap), dead(cap), tick(0), hang(1), column(cap), alive(cap + 1)
+{
+  buildTransitions();
+}
+
+void PerfectBot::begin(const RbrGame &game)
+{
+  RbrGame future = game;
+  std::vector<uint16_t> &reach = alive;
+  hang = game.tuning->jumpHang;
+  int8_t(*moves)[HERO_POSITIONS][2] = transitions[hang - 1];
+
+  // Forward: where the hero can be before each tick
+  reach[0] = 1 << game.hero;
+  dead = cap;
+  for (uint32_t t = 0; t < cap; ++t)
+  {
+    rbrTerrainStep(future);
+    uint8_t now = column[t] = heroColumn(future);
+    uint16_t next = 0;
+    for (uint8_t hero = 0; hero < HERO_POSITIONS; ++hero)
+    {
+      if (!(reach[t] & (1 << hero)))
+        continue;
+      for (uint8_t jump = 0; jump < 2; ++jump)
+      {
+        int8_t to = moves[now][hero][jump];
+        if (to >= 0)
+          next |= 1 << to;
+      }
+    }
+    reach[t + 1] = next;
+    if (!next)
+    {
+      dead = t;
+      break;
+    }
+  }
+
+  // Backward: keep the positions that still reach the last tick
+  for (uint32_t t = dead; t-- > 0;)
+  {
+    uint16_t keep = 0;
+    for (uint8_t hero = 0; hero < HERO_POSITIONS; ++hero)
+    {
+      if (!(reach[t] & (1 << hero)))
+        continue;
+      for (uint8_t jump = 0; jump < 2; ++jump)
+      {
+        int8_t to = moves[column[t]][hero][jump];
+        if (to >= 0 && (alive[t + 1] & (1 << to)))
+          keep |= 1 << hero;
+      }
+    }
+    alive[t] = keep;
+  }
+  tick = 0;
+}
+
+bool PerfectBot::jump(const RbrGame &game)
+{
+  uint32_t t = tick++;
+  if (t >= dead)
+  {
+    return false;
+  }
+  // Prefer running on
+  int8_t to = transitions[hang - 1][column[t]][game.hero][0];
+  return to < 0 || !(alive[t + 1] & (1 << to));
+}
+
+void PerfectBot::history(char *text, size_t size, uint8_t runs) const
+{
+  // Collect the runs backwards from the dead tick
+  char kinds[8];
+  uint32_t lengths[8];
+  uint8_t count = 0;
+  if (runs > 8)
+    runs = 8;
+  for (uint32_t t = dead + 1; t-- > 0 && t < cap;)
+  {
+    char kind = (column[t] & 2) ? 'L' : (column[t] & 1) ? 'U' : '_';
+    if (count && kinds[count - 1] == kind)
+    {
+      lengths[count - 1]++;
+      continue;
+    }
+    if (count == runs)
+      break;
+    kinds[count] = kind;
+    lengths[count++] = 1;
+  }
+  size_t at = 0;
+  text[0] = '\0';
+  while (count-- && at < size)
+  {
+    at += snprintf(text + at, size - at, at ? " %c%u" : "%c%u", kinds[count], lengths[count]);
+  }
+}
+
+ReflexBot::ReflexBot(uint16_t reactionMs, uint8_t lead) : reactionMs(reactionMs), lead(lead), newest(0), seen(0)
+{
+}
+
+void ReflexBot::begin(const RbrGame &game)
+{
+  (void)game;
+  newest = 0;
+  seen = 0;
+}
+
+// Half cells from the hero column to the first solid half in front of it
+static uint8_t gap(const TerrainRow &row)
+{
+  uint32_t left = row.left >> (RBR_HERO_COLUMN + 1);
+  uint32_t right = row.right >> (RBR_HERO_COLUMN + 1);
+  uint8_t gap = 0xFF;
+  if (left)
+    gap = 2 * __builtin_ctz(left);
+  if (right && 2 * __builtin_ctz(right) + 1 < gap)
+    gap = 2 * __builtin_ctz(right) + 1;
+  return gap;
+}
+
+bool ReflexBot::jump(const RbrGame &game)
+{
+  newest = (newest + 1) % HISTORY;
+  upper[newest] = game.upper;
+  lower[newest] = game.lower;
+  if (seen < HISTORY)
+    seen++;
+
+  if (game.hero > HERO_POSITION_RUN_LOWER_2)
+  {
+    return false;
+  }
+  // Picture that reaches the decision now
+  uint16_t period = game.carry.speed ? game.carry.speed : 1;
+  uint32_t delay = (reactionMs + period - 1) / period;
+  if (delay >= seen)
+    delay = seen - 1;
+  uint8_t view = (newest + HISTORY - delay) % HISTORY;
+
+  uint8_t block = gap(lower[view]);
+  uint8_t overhead = gap(upper[view]);
+  // The hero is in the upper row from the 2nd tick of a jump to the one
+  // after the hang, a half that is n half cells away reaches its column
+  // after n + 1 ticks
+  uint8_t reach = game.tuning->jumpHang + 1;
+  bool upperClear = !terrainSolid(upper[view], RBR_HERO_COLUMN) && (overhead == 0xFF || overhead > reach + delay);
+  return block <= lead && upperClear;
+}
@@ -0,0 +1,77 @@
+/*
+Jump policies for the RBR simulator.
+
+A bot is asked once per tick, before rbrGameStep(), whether to press jump.
+*/
+
+#ifndef BOTS_H
+#define BOTS_H
+
+#include "RbrGame.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+class Bot
+{
+public:
+  virtual ~Bot() {}
+  // A new game was set up with rbrGameNew()
+  virtual void begin(const RbrGame &game) { (void)game; }
+  virtual bool jump(const RbrGame &game) = 0;
+};
+
+/*
+Knows the whole future terrain. The terrain does not depend on the hero,
+so the positions the hero can be in before every tick form a small set.
+begin() computes these sets forward until one becomes empty, which is the
+first tick no policy can survive, then keeps backwards only the positions
+that still lead up to that tick. jump() stays inside those.
+*/
+class PerfectBot : public Bot
+{
+public:
+  explicit PerfectBot(uint32_t cap);
+  void begin(const RbrGame &game) override;
+  bool jump(const RbrGame &game) override;
+
+  // First tick the terrain cannot be survived, or the cap
+  uint32_t deadTick() const { return dead; }
+  bool unwinnable() const { return dead < cap; }
+  // Last `runs` stretches of terrain in the hero column up to deadTick(),
+  // e.g. "_9 L12 _3 L1": '_' free, 'L' lower block, 'U' upper block, each
+  // with its length in ticks
+  void history(char *text, size_t size, uint8_t runs) const;
+
+private:
+  uint32_t cap;
+  uint32_t dead;
+  uint32_t tick;
+  uint8_t hang;                 // Jump hang of the tuning begin() saw
+  std::vector<uint8_t> column;  // Bit 0 upper, bit 1 lower solid
+  std::vector<uint16_t> alive;  // Positions before each tick
+};
+
+/*
+Reacts to what it saw `reactionMs` ago: jumps from the ground when a lower
+block is within `lead` half cells in front of the hero, unless an upper
+block is close enough to hit on the way up.
+*/
+class ReflexBot : public Bot
+{
+public:
+  ReflexBot(uint16_t reactionMs, uint8_t lead);
+  void begin(const RbrGame &game) override;
+  bool jump(const RbrGame &game) override;
+
+private:
+  static const uint8_t HISTORY = 64;
+  uint16_t reactionMs;
+  uint8_t lead;
+  uint8_t newest;
+  uint8_t seen;
+  TerrainRow upper[HISTORY];
+  TerrainRow lower[HISTORY];
+};
+
+#endif
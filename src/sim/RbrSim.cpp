@@ -0,0 +1,312 @@
+/*
+Headless RBR batch simulator.
+
+Plays many games with the console's rules (RbrGame.cpp) and a bot on all
+cores and writes three CSV files:
+
+    <prefix>-survival.csv    games still running at each distance
+    <prefix>-levels.csv      games that reached and ended in each level
+    <prefix>-unwinnable.csv  terrain in the hero column before the tick
+                             no policy survives (perfect bot only)
+
+Every game starts from the start speed, nothing carries over. A game is
+decided by the RNG state it starts from, and the 16-bit generator has
+RBR_GAMES of them, so that is as many different games as there are; -n
+is capped there and the default plays each of them once. Game i is
+seeded from the base seed and i, so a run can be repeated, and a seed can
+be checked on the console through the replay header.
+
+Usage: rbrsim [-n games] [-j threads] [-b perfect|reflex] [-r reaction_ms]
+              [-l lead_half_cells] [-c cap_ticks] [-s seed] [-o prefix]
+              [--speed ms] [--stages ticks] [--upper-odds n]
+              [--block min,range] [--gap min,range] [--step ticks]
+       rbrsim --rng-check
+*/
+
+#include "Bots.h"
+#include "RbrGame.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Terrain runs shown per unwinnable sequence
+#define HISTORY_RUNS 3
+// Start states of the RNG, one game each
+#define RBR_GAMES 65535
+// Steps through the start states, no factor in common with RBR_GAMES
+#define SEED_STRIDE 40507
+
+struct Options
+{
+  uint64_t games = RBR_GAMES;
+  unsigned threads = 0;
+  bool perfect = true;
+  uint16_t reactionMs = 200;
+  uint8_t lead = 2;
+  uint32_t cap = 10000;
+  uint32_t seed = 1;
+  const char *prefix = "rbrsim";
+  uint16_t speed = RBR_START_SPEED;
+  uint32_t step = 25;
+  RbrTuning tuning = rbrDefaultTuning;
+};
+
+struct Results
+{
+  std::vector<uint64_t> ended;         // Games by final distance
+  std::vector<uint64_t> endedInLevel;  // Games by final level
+  std::vector<uint64_t> distanceInLevel;
+  std::map<std::string, uint64_t> unwinnable;
+  uint64_t ticks = 0;
+  uint64_t capped = 0;
+
+  explicit Results(uint32_t cap) : ended(cap + 1) {}
+
+  void add(const RbrGame &game)
+  {
+    ended[game.distance]++;
+    if (game.level >= endedInLevel.size())
+    {
+      endedInLevel.resize(game.level + 1);
+      distanceInLevel.resize(game.level + 1);
+    }
+    endedInLevel[game.level]++;
+    distanceInLevel[game.level] += game.distance;
+    ticks += game.distance;
+  }
+
+  void merge(const Results &other)
+  {
+    for (size_t i = 0; i < ended.size(); ++i)
+      ended[i] += other.ended[i];
+    if (other.endedInLevel.size() > endedInLevel.size())
+    {
+      endedInLevel.resize(other.endedInLevel.size());
+      distanceInLevel.resize(other.endedInLevel.size());
+    }
+    for (size_t i = 0; i < other.endedInLevel.size(); ++i)
+    {
+      endedInLevel[i] += other.endedInLevel[i];
+      distanceInLevel[i] += other.distanceInLevel[i];
+    }
+    for (const auto &entry : other.unwinnable)
+      unwinnable[entry.first] += entry.second;
+    ticks += other.ticks;
+    capped += other.capped;
+  }
+};
+
+// Spreads consecutive game numbers over the RNG's start states. Seeds
+// below 65536 are the state itself, and any RBR_GAMES consecutive games
+// get different ones.
+uint32_t gameSeed(uint32_t base, uint64_t game)
+{
+  return 1 + (base + game * SEED_STRIDE) % RBR_GAMES;
+}
+
+static void play(const Options &options, uint64_t first, uint64_t last, Results &results)
+{
+  std::unique_ptr<Bot> bot;
+  PerfectBot *perfect = 0;
+  if (options.perfect)
+    bot.reset(perfect = new PerfectBot(options.cap));
+  else
+    bot.reset(new ReflexBot(options.reactionMs, options.lead));
+
+  RbrGame game = {};
+  game.tuning = &options.tuning;
+  char history[64];
+  for (uint64_t i = first; i < last; ++i)
+  {
+    game.carry.speed = options.speed;
+    game.carry.stage = 0;
+    game.carry.highScore = 0;
+    rbrGameNew(game, gameSeed(options.seed, i));
+    bot->begin(game);
+    while (game.distance < options.cap && rbrGameStep(game, bot->jump(game)))
+    {
+    }
+    if (game.distance >= options.cap)
+      results.capped++;
+    results.add(game);
+    if (perfect && perfect->unwinnable())
+    {
+      perfect->history(history, sizeof(history), HISTORY_RUNS);
+      results.unwinnable[history]++;
+    }
+  }
+}
+
+static FILE *openCsv(const char *prefix, const char *name)
+{
+  std::string path = std::string(prefix) + "-" + name + ".csv";
+  FILE *file = fopen(path.c_str(), "w");
+  if (!file)
+  {
+    fprintf(stderr, "cannot write %s\n", path.c_str());
+    exit(1);
+  }
+  return file;
+}
+
+static void writeCsv(const Options &options, const Results &results)
+{
+  FILE *file = openCsv(options.prefix, "survival");
+  fprintf(file, "distance,running,fraction\n");
+  uint64_t running = options.games;
+  for (uint32_t distance = 0; distance <= options.cap && running; ++distance)
+  {
+    if (distance % options.step == 0)
+      fprintf(file, "%u,%llu,%.6f\n", distance, (unsigned long long)running, (double)running / options.games);
+    running -= results.ended[distance];
+  }
+  fclose(file);
+
+  file = openCsv(options.prefix, "levels");
+  fprintf(file, "level,reached,ended,mean_distance\n");
+  uint64_t reached = options.games;
+  for (size_t level = 0; level < results.endedInLevel.size(); ++level)
+  {
+    uint64_t ended = results.endedInLevel[level];
+    fprintf(file, "%u,%llu,%llu,%.1f\n", (unsigned)level, (unsigned long long)reached, (unsigned long long)ended,
+            ended ? (double)results.distanceInLevel[level] / ended : 0.0);
+    reached -= ended;
+  }
+  fclose(file);
+
+  if (!options.perfect)
+    return;
+  std::vector<std::pair<uint64_t, std::string>> sorted;
+  uint64_t total = 0;
+  for (const auto &entry : results.unwinnable)
+  {
+    sorted.push_back(std::make_pair(entry.second, entry.first));
+    total += entry.second;
+  }
+  std::sort(sorted.begin(), sorted.end(), [](const std::pair<uint64_t, std::string> &a, const std::pair<uint64_t, std::string> &b) { return a.first > b.first; });
+  file = openCsv(options.prefix, "unwinnable");
+  fprintf(file, "hero_column,count,share\n");
+  for (const auto &entry : sorted)
+    fprintf(file, "%s,%llu,%.6f\n", entry.second.c_str(), (unsigned long long)entry.first, (double)entry.first / total);
+  fclose(file);
+}
+
+static bool parsePair(const char *text, uint8_t &first, uint8_t &second)
+{
+  unsigned a, b;
+  if (sscanf(text, "%u,%u", &a, &b) != 2 || a > 255 || b > 255)
+    return false;
+  first = a;
+  second = b;
+  return true;
+}
+
+static bool parse(int argc, char **argv, Options &options)
+{
+  for (int i = 1; i < argc; ++i)
+  {
+    const char *arg = argv[i];
+    const char *value = i + 1 < argc ? argv[i + 1] : 0;
+    if (!value)
+      return false;
+    ++i;
+    if (strcmp(arg, "-n") == 0)
+      options.games = strtoull(value, 0, 10);
+    else if (strcmp(arg, "-j") == 0)
+      options.threads = atoi(value);
+    else if (strcmp(arg, "-b") == 0 && (strcmp(value, "perfect") == 0 || strcmp(value, "reflex") == 0))
+      options.perfect = strcmp(value, "perfect") == 0;
+    else if (strcmp(arg, "-r") == 0)
+      options.reactionMs = atoi(value);
+    else if (strcmp(arg, "-l") == 0)
+      options.lead = atoi(value);
+    else if (strcmp(arg, "-c") == 0)
+      options.cap = atol(value);
+    else if (strcmp(arg, "-s") == 0)
+      options.seed = strtoul(value, 0, 0);
+    else if (strcmp(arg, "-o") == 0)
+      options.prefix = value;
+    else if (strcmp(arg, "--speed") == 0)
+      options.speed = atoi(value);
+    else if (strcmp(arg, "--stages") == 0)
+      options.tuning.stagesPerLevel = atoi(value);
+    else if (strcmp(arg, "--upper-odds") == 0)
+      options.tuning.upperOdds = atoi(value);
+    else if (strcmp(arg, "--block") == 0 && parsePair(value, options.tuning.blockMin, options.tuning.blockRange))
+      ;
+    else if (strcmp(arg, "--gap") == 0 && parsePair(value, options.tuning.gapMin, options.tuning.gapRange))
+      ;
+    else if (strcmp(arg, "--hang") == 0)
+      options.tuning.jumpHang = atoi(value);
+    else if (strcmp(arg, "--step") == 0)
+      options.step = atol(value);
+    else
+      return false;
+  }
+  // The distance counter of the game is 16 bits
+  return options.games && options.cap && options.cap < 65535 && options.step && options.lead < 2 * TERRAIN_WIDTH &&
+         options.tuning.blockMin + options.tuning.blockRange > 0 && options.tuning.gapMin + options.tuning.gapRange > 0 &&
+         options.tuning.jumpHang >= 1 && options.tuning.jumpHang <= RBR_JUMP_HANG_MAX;
+}
+
+int rngCheck();
+
+int main(int argc, char **argv)
+{
+  Options options;
+  if (argc == 2 && strcmp(argv[1], "--rng-check") == 0)
+    return rngCheck();
+  if (!parse(argc, argv, options))
+  {
+    fprintf(stderr, "usage: %s [-n games] [-j threads] [-b perfect|reflex] [-r reaction_ms] [-l lead_half_cells]\n"
+                    "       [-c cap_ticks] [-s seed] [-o prefix] [--speed ms] [--stages ticks]\n"
+                    "       [--upper-odds n] [--block min,range] [--gap min,range] [--hang ticks]\n"
+                    "       [--step ticks]\n",
+            argv[0]);
+    return 1;
+  }
+  if (options.games > RBR_GAMES)
+  {
+    fprintf(stderr, "only %u different games exist, playing each once\n", RBR_GAMES);
+    options.games = RBR_GAMES;
+  }
+  if (!options.threads)
+    options.threads = std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 1;
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<Results> results(options.threads, Results(options.cap));
+  std::vector<std::thread> workers;
+  for (unsigned t = 0; t < options.threads; ++t)
+  {
+    uint64_t first = options.games * t / options.threads;
+    uint64_t last = options.games * (t + 1) / options.threads;
+    workers.emplace_back(play, std::cref(options), first, last, std::ref(results[t]));
+  }
+  for (unsigned t = 0; t < options.threads; ++t)
+  {
+    workers[t].join();
+    if (t)
+      results[0].merge(results[t]);
+  }
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  writeCsv(options, results[0]);
+  uint64_t unwinnable = 0;
+  for (const auto &entry : results[0].unwinnable)
+    unwinnable += entry.second;
+  printf("%llu of %u games on %u threads in %.2f s (%.0f games/s, %.1f Mticks/s)\n", (unsigned long long)options.games,
+         RBR_GAMES, options.threads, seconds, options.games / seconds, results[0].ticks / seconds / 1e6);
+  printf("mean distance %.1f, reached the cap %llu", (double)results[0].ticks / options.games,
+         (unsigned long long)results[0].capped);
+  if (options.perfect)
+    printf(", unwinnable %llu", (unsigned long long)unwinnable);
+  printf("\n");
+  return 0;
+}
@@ -0,0 +1,173 @@
+/*
+Statistical checks of the game's RNG (rbrsim --rng-check).
+
+The period of the generator, the balance of every output bit, chi-square
+tests of rngBelow() for the ranges the terrain uses, of pairs of
+consecutive draws and of the terrain run lengths, and how many different
+generator states the simulator's game seeds reach. Critical values are
+for p = 0.001 (Wilson-Hilferty approximation).
+*/
+
+#include "RbrGame.h"
+#include "Rng.h"
+#include <math.h>
+#include <stdio.h>
+#include <vector>
+
+// One full period, longer samples only repeat it
+#define DRAWS 65535
+
+uint32_t gameSeed(uint32_t base, uint64_t game);
+
+static bool passed = true;
+
+static void result(const char *name, bool ok, const char *detail)
+{
+  printf("%-4s %-28s %s\n", ok ? "ok" : "FAIL", name, detail);
+  passed &= ok;
+}
+
+// Chi-square value exceeded with probability 0.001
+static double critical(unsigned freedom)
+{
+  double z = 3.0902;
+  double k = freedom;
+  double t = 1 - 2 / (9 * k) + z * sqrt(2 / (9 * k));
+  return k * t * t * t;
+}
+
+static double chiSquare(const std::vector<uint64_t> &counts, uint64_t total)
+{
+  double expected = (double)total / counts.size();
+  double sum = 0;
+  for (uint64_t count : counts)
+    sum += (count - expected) * (count - expected) / expected;
+  return sum;
+}
+
+static void checkChi(const char *name, const std::vector<uint64_t> &counts, uint64_t total)
+{
+  char detail[96];
+  double chi = chiSquare(counts, total);
+  double limit = critical(counts.size() - 1);
+  snprintf(detail, sizeof(detail), "chi2 %.1f, limit %.1f (%zu cells)", chi, limit, counts.size());
+  result(name, chi < limit, detail);
+}
+
+static void checkPeriod()
+{
+  Rng rng;
+  rngSeed(rng, 1);
+  uint16_t first = rng.state;
+  std::vector<bool> seen(65536);
+  uint32_t period = 0;
+  do
+  {
+    seen[rngNext(rng)] = true;
+    period++;
+  } while (rng.state != first && period <= 65536);
+  char detail[96];
+  snprintf(detail, sizeof(detail), "%u, zero %s", period, seen[0] ? "reached" : "never reached");
+  result("period", period == 65535 && !seen[0], detail);
+}
+
+static void checkBits()
+{
+  Rng rng;
+  rngSeed(rng, 12345);
+  uint64_t ones[16] = {0};
+  for (uint32_t i = 0; i < DRAWS; ++i)
+  {
+    uint16_t x = rngNext(rng);
+    for (uint8_t bit = 0; bit < 16; ++bit)
+      ones[bit] += (x >> bit) & 1;
+  }
+  // Each bit is a binomial, allow 4 standard deviations
+  double worst = 0;
+  for (uint8_t bit = 0; bit < 16; ++bit)
+    worst = fmax(worst, fabs(ones[bit] - DRAWS / 2.0) / sqrt(DRAWS / 4.0));
+  char detail[96];
+  snprintf(detail, sizeof(detail), "worst bit %.2f sigma", worst);
+  result("bit balance", worst < 4, detail);
+}
+
+static void checkBelow(uint8_t max)
+{
+  Rng rng;
+  rngSeed(rng, 777);
+  std::vector<uint64_t> counts(max);
+  for (uint32_t i = 0; i < DRAWS; ++i)
+    counts[rngBelow(rng, max)]++;
+  char name[32];
+  snprintf(name, sizeof(name), "rngBelow(%u)", max);
+  checkChi(name, counts, DRAWS);
+}
+
+static void checkPairs(uint8_t max)
+{
+  Rng rng;
+  rngSeed(rng, 4242);
+  std::vector<uint64_t> counts(max * max);
+  uint8_t previous = rngBelow(rng, max);
+  for (uint32_t i = 0; i < DRAWS; ++i)
+  {
+    uint8_t next = rngBelow(rng, max);
+    counts[previous * max + next]++;
+    previous = next;
+  }
+  char name[32];
+  snprintf(name, sizeof(name), "pairs of rngBelow(%u)", max);
+  checkChi(name, counts, DRAWS);
+}
+
+// Blocks and gaps as the terrain draws them: upper odds, block and gap
+// length in turn
+static void checkTerrain()
+{
+  const RbrTuning &tuning = rbrDefaultTuning;
+  Rng rng;
+  rngSeed(rng, 99);
+  std::vector<uint64_t> upper(tuning.upperOdds), block(tuning.blockRange), gap(tuning.gapRange);
+  uint32_t runs = DRAWS / 3;
+  for (uint32_t i = 0; i < runs; ++i)
+  {
+    upper[rngBelow(rng, tuning.upperOdds)]++;
+    block[rngBelow(rng, tuning.blockRange)]++;
+    gap[rngBelow(rng, tuning.gapRange)]++;
+  }
+  checkChi("terrain block type", upper, runs);
+  checkChi("terrain block length", block, runs);
+  checkChi("terrain gap length", gap, runs);
+}
+
+static void checkSeeds()
+{
+  // Every game of a full simulator run starts from a different state
+  std::vector<bool> seen(65536);
+  uint32_t distinct = 0;
+  for (uint32_t game = 0; game < 65535; ++game)
+  {
+    Rng rng;
+    rngSeed(rng, gameSeed(1, game));
+    distinct += !seen[rng.state];
+    seen[rng.state] = true;
+  }
+  char detail[96];
+  snprintf(detail, sizeof(detail), "%u of 65535 game seeds", distinct);
+  result("distinct start states", distinct == 65535, detail);
+}
+
+int rngCheck()
+{
+  checkPeriod();
+  checkBits();
+  checkBelow(3);
+  checkBelow(10);
+  checkBelow(7);
+  checkBelow(255);
+  checkPairs(3);
+  checkPairs(10);
+  checkTerrain();
+  checkSeeds();
+  return passed ? 0 : 1;
+}
@@ -0,0 +1,151 @@
+// BCD counters (include/Bcd.h): counting with carries and the digits that
+// get redrawn (pio test -e native)
+
+#include <unity.h>
+#include "Bcd.h"
+#include "FrameBuffer.h"
+
+#define ALL_DIRTY ((1 << BCD_DIGITS) - 1)
+
+static uint32_t value(const BcdCounter &counter)
+{
+  uint32_t result = 0;
+  for (uint8_t digit = BCD_DIGITS; digit-- > 0;)
+    result = result * 10 + bcdDigit(counter, digit);
+  return result;
+}
+
+static uint8_t decimalLength(uint32_t number)
+{
+  uint8_t length = 1;
+  while (number >= 10)
+  {
+    number /= 10;
+    length++;
+  }
+  return length;
+}
+
+// Counter at `number` with nothing left to draw
+static BcdCounter drawnAt(uint16_t number)
+{
+  BcdCounter counter;
+  bcdSet(counter, number);
+  counter.dirty = 0;
+  return counter;
+}
+
+void setUp()
+{
+  fb.clear();
+}
+
+void tearDown()
+{
+}
+
+// Counting up matches binary counting, digits and length
+void test_increment_counts()
+{
+  BcdCounter counter;
+  bcdClear(counter);
+  for (uint32_t number = 1; number <= 65535; ++number)
+  {
+    bcdIncrement(counter);
+    if (value(counter) != number || counter.length != decimalLength(number))
+    {
+      TEST_ASSERT_EQUAL(number, value(counter));
+      TEST_ASSERT_EQUAL(decimalLength(number), counter.length);
+    }
+  }
+}
+
+void test_set()
+{
+  static const uint16_t values[] = {0, 7, 10, 99, 100, 4321, 65535};
+  for (uint8_t i = 0; i < sizeof(values) / sizeof(values[0]); ++i)
+  {
+    BcdCounter counter;
+    bcdSet(counter, values[i]);
+    TEST_ASSERT_EQUAL(values[i], value(counter));
+    TEST_ASSERT_EQUAL(decimalLength(values[i]), counter.length);
+  }
+}
+
+// Only the digits that changed are dirty, unless the length changed
+void test_dirty_digits()
+{
+  BcdCounter counter = drawnAt(41);
+  bcdIncrement(counter);
+  TEST_ASSERT_EQUAL(0x01, counter.dirty);
+
+  counter = drawnAt(19);
+  bcdIncrement(counter);
+  TEST_ASSERT_EQUAL(0x03, counter.dirty);
+
+  // Carry out of the low byte into the hundreds
+  counter = drawnAt(199);
+  bcdIncrement(counter);
+  TEST_ASSERT_EQUAL(200, value(counter));
+  TEST_ASSERT_EQUAL(0x07, counter.dirty);
+
+  // One more digit: left-aligned, so every cell moves
+  counter = drawnAt(9);
+  bcdIncrement(counter);
+  TEST_ASSERT_EQUAL(ALL_DIRTY, counter.dirty);
+  counter = drawnAt(999);
+  bcdIncrement(counter);
+  TEST_ASSERT_EQUAL(1000, value(counter));
+  TEST_ASSERT_EQUAL(ALL_DIRTY, counter.dirty);
+}
+
+// bcdDraw() writes the dirty cells only, most significant digit at col
+void test_draw_changed_cells()
+{
+  BcdCounter counter;
+  bcdSet(counter, 41);
+  bcdDraw(counter, 2, 1, false);
+  TEST_ASSERT_EQUAL('4', fb.at(2, 1));
+  TEST_ASSERT_EQUAL('1', fb.at(3, 1));
+  TEST_ASSERT_EQUAL(0, counter.dirty);
+
+  // Marks tell which cells were written again
+  fb.setCursor(2, 1);
+  fb.print("##");
+  bcdIncrement(counter);
+  bcdDraw(counter, 2, 1, false);
+  TEST_ASSERT_EQUAL('#', fb.at(2, 1));
+  TEST_ASSERT_EQUAL('2', fb.at(3, 1));
+
+  // `all` redraws every digit
+  bcdDraw(counter, 2, 1, true);
+  TEST_ASSERT_EQUAL('4', fb.at(2, 1));
+  TEST_ASSERT_EQUAL('2', fb.at(3, 1));
+}
+
+void test_copy_and_compare()
+{
+  BcdCounter shown = drawnAt(1289);
+  BcdCounter next = drawnAt(1300);
+  TEST_ASSERT_TRUE(bcdCompare(shown, next) < 0);
+  TEST_ASSERT_TRUE(bcdCompare(next, shown) > 0);
+  bcdCopy(shown, next);
+  // Hundreds, tens and ones changed, the thousands did not
+  TEST_ASSERT_EQUAL(0x07, shown.dirty);
+  TEST_ASSERT_EQUAL(0, bcdCompare(shown, next));
+
+  BcdCounter shorter = drawnAt(999);
+  bcdCopy(shorter, next);
+  TEST_ASSERT_EQUAL(ALL_DIRTY, shorter.dirty);
+}
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_increment_counts);
+  RUN_TEST(test_set);
+  RUN_TEST(test_dirty_digits);
+  RUN_TEST(test_draw_changed_cells);
+  RUN_TEST(test_copy_and_compare);
+  return UNITY_END();
+}
@@ -0,0 +1,179 @@
+// EEPROM journal (include/Persist.h): the scan for the newest record, the
+// CRC, the sequence number wrap and torn saves (pio test -e native)
+
+#include <unity.h>
+#include "Hal.h"
+#include "Persist.h"
+
+static const PersistData sample = {1234, 0xDEADBEEF, 150, 25};
+
+static void erase()
+{
+  for (uint16_t address = PERSIST_EEPROM_START; address < PERSIST_EEPROM_END; ++address)
+    halEepromWrite(address, 0xFF);
+}
+
+// CRC-8 Maxim, initial value 0xFF, as the format specifies
+static uint8_t crc8(const uint8_t *data, uint8_t length)
+{
+  uint8_t crc = 0xFF;
+  while (length--)
+  {
+    crc ^= *data++;
+    for (uint8_t bit = 0; bit < 8; ++bit)
+      crc = (crc & 1) ? (crc >> 1) ^ 0x8C : crc >> 1;
+  }
+  return crc;
+}
+
+// A record written by hand, with any sequence number
+static void writeRecord(uint8_t slot, uint16_t sequence, uint16_t highScore, bool goodCrc = true)
+{
+  uint8_t record[PERSIST_RECORD_SIZE] = {(uint8_t)sequence, (uint8_t)(sequence >> 8),
+                                         (uint8_t)highScore, (uint8_t)(highScore >> 8),
+                                         1, 2, 3, 4, 150, 0, 25};
+  record[11] = crc8(record, PERSIST_RECORD_SIZE - 1) ^ (goodCrc ? 0 : 0x5A);
+  for (uint8_t i = 0; i < PERSIST_RECORD_SIZE; ++i)
+    halEepromWrite(PERSIST_EEPROM_START + slot * PERSIST_RECORD_SIZE + i, record[i]);
+}
+
+static uint16_t sequenceAt(uint8_t slot)
+{
+  uint16_t address = PERSIST_EEPROM_START + slot * PERSIST_RECORD_SIZE;
+  return halEepromRead(address) | (halEepromRead(address + 1) << 8);
+}
+
+// High score of the newest record, 0 when there is none
+static uint16_t loadedScore()
+{
+  PersistData data = {0, 0, 0, 0};
+  return persistBegin(data) ? data.highScore : 0;
+}
+
+void setUp()
+{
+  erase();
+}
+
+void tearDown()
+{
+}
+
+void test_empty()
+{
+  PersistData data = sample;
+  TEST_ASSERT_FALSE(persistBegin(data));
+  TEST_ASSERT_EQUAL(sample.highScore, data.highScore);
+  TEST_ASSERT_EQUAL(sample.seed, data.seed);
+}
+
+void test_save_load()
+{
+  PersistData data = sample;
+  persistBegin(data);
+  persistSave(sample);
+  PersistData loaded = {0, 0, 0, 0};
+  TEST_ASSERT_TRUE(persistBegin(loaded));
+  TEST_ASSERT_EQUAL(sample.highScore, loaded.highScore);
+  TEST_ASSERT_EQUAL(sample.seed, loaded.seed);
+  TEST_ASSERT_EQUAL(sample.startSpeed, loaded.startSpeed);
+  TEST_ASSERT_EQUAL(sample.backlight, loaded.backlight);
+}
+
+// More saves than slots: the journal goes round and the last one wins
+void test_round_robin()
+{
+  PersistData data = sample;
+  persistBegin(data);
+  for (uint16_t i = 1; i <= 3 * PERSIST_SLOTS + 5; ++i)
+  {
+    data.highScore = i;
+    persistSave(data);
+    TEST_ASSERT_EQUAL(i, loadedScore());
+  }
+}
+
+// Saving what is already stored writes nothing
+void test_unchanged_not_written()
+{
+  PersistData data = sample;
+  persistBegin(data);
+  persistSave(sample);
+  uint16_t first = sequenceAt(0);
+  persistSave(sample);
+  TEST_ASSERT_EQUAL(first, sequenceAt(0));
+  TEST_ASSERT_EQUAL(0xFFFF, sequenceAt(1));
+}
+
+// A save cut short before its sequence number leaves the previous record
+void test_torn_save()
+{
+  PersistData data = sample;
+  persistBegin(data);
+  for (uint16_t i = 1; i <= PERSIST_SLOTS + 3; ++i)
+  {
+    data.highScore = i;
+    persistSave(data);
+  }
+  // The last save went to slot 2. Only part of the next one's payload
+  // made it to slot 3, its sequence number is still the old one.
+  uint16_t address = PERSIST_EEPROM_START + 3 * PERSIST_RECORD_SIZE;
+  halEepromWrite(address + 2, 0x77);
+  halEepromWrite(address + 3, 0x77);
+  TEST_ASSERT_EQUAL(PERSIST_SLOTS + 3, loadedScore());
+}
+
+// A record that fails its CRC is never loaded
+void test_bad_crc()
+{
+  writeRecord(0, 10, 100);
+  writeRecord(1, 11, 110);
+  writeRecord(2, 12, 120);
+  writeRecord(5, 20, 200, false);
+  TEST_ASSERT_EQUAL(120, loadedScore());
+}
+
+// The newest of two runs by serial number arithmetic
+void test_newest_run()
+{
+  writeRecord(0, 100, 1);
+  writeRecord(7, 90, 2);
+  TEST_ASSERT_EQUAL(1, loadedScore());
+  // 0x0005 follows 0xFFF0 once the numbers wrapped
+  erase();
+  writeRecord(0, 0xFFF0, 1);
+  writeRecord(7, 0x0005, 2);
+  TEST_ASSERT_EQUAL(2, loadedScore());
+}
+
+// 0xFFFF means erased, the sequence number skips it
+void test_sequence_wrap()
+{
+  writeRecord(3, 0xFFFD, 1);
+  writeRecord(4, 0xFFFE, 2);
+  PersistData data = sample;
+  TEST_ASSERT_TRUE(persistBegin(data));
+  TEST_ASSERT_EQUAL(2, data.highScore);
+  data.highScore = 3;
+  persistSave(data);
+  TEST_ASSERT_EQUAL(0, sequenceAt(5));
+  TEST_ASSERT_EQUAL(3, loadedScore());
+  data.highScore = 4;
+  persistSave(data);
+  TEST_ASSERT_EQUAL(1, sequenceAt(6));
+  TEST_ASSERT_EQUAL(4, loadedScore());
+}
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_empty);
+  RUN_TEST(test_save_load);
+  RUN_TEST(test_round_robin);
+  RUN_TEST(test_unchanged_not_written);
+  RUN_TEST(test_torn_save);
+  RUN_TEST(test_bad_crc);
+  RUN_TEST(test_newest_run);
+  RUN_TEST(test_sequence_wrap);
+  return UNITY_END();
+}
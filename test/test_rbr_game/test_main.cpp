@@ -0,0 +1,158 @@
+// RBR rules and their RNG: a game is a function of its seed and its jumps,
+// which replays and the simulator rely on (pio test -e native)
+
+#include <unity.h>
+#include "RbrGame.h"
+#include "Rng.h"
+
+#define TICKS 3000
+
+static RbrGame newGame(uint32_t seed)
+{
+  RbrGame game = {&rbrDefaultTuning, {RBR_START_SPEED, 0, 0}, HERO_POSITION_RUN_LOWER_1, HERO_POSITION_RUN_LOWER_1,
+                  {}, {}, {}, 0, 0, 0, 0};
+  rbrGameNew(game, seed);
+  return game;
+}
+
+// Jumps over every lower block for `skill` ticks, then stops jumping, so
+// runs end after different distances
+static bool jumpAt(const RbrGame &game, uint16_t tick, uint16_t skill)
+{
+  return tick < skill && terrainSolid(game.lower, RBR_HERO_COLUMN + 2);
+}
+
+static bool sameState(const RbrGame &a, const RbrGame &b)
+{
+  return a.hero == b.hero && a.pose == b.pose && a.rng.state == b.rng.state && a.upper.left == b.upper.left &&
+         a.upper.right == b.upper.right && a.lower.left == b.lower.left && a.lower.right == b.lower.right &&
+         a.terrainType == b.terrainType && a.terrainDuration == b.terrainDuration && a.distance == b.distance &&
+         a.level == b.level && a.carry.speed == b.carry.speed && a.carry.stage == b.carry.stage &&
+         a.carry.highScore == b.carry.highScore;
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+// Two games from one seed with the same jumps stay identical every tick
+void test_same_seed_same_game()
+{
+  for (uint32_t seed = 1; seed <= 20; ++seed)
+  {
+    RbrGame a = newGame(seed);
+    RbrGame b = newGame(seed);
+    uint16_t skill = seed * 100;
+    for (uint16_t tick = 0; tick < TICKS; ++tick)
+    {
+      bool aliveA = rbrGameStep(a, jumpAt(a, tick, skill));
+      bool aliveB = rbrGameStep(b, jumpAt(b, tick, skill));
+      TEST_ASSERT_EQUAL(aliveA, aliveB);
+      TEST_ASSERT_TRUE(sameState(a, b));
+      if (!aliveA)
+        break;
+    }
+  }
+}
+
+// rbrGameNew() leaves nothing behind from the previous game
+void test_new_game_restarts()
+{
+  RbrGame game = newGame(1234);
+  uint16_t first = 0;
+  while (first < TICKS && rbrGameStep(game, jumpAt(game, first, 500)))
+    first++;
+  TEST_ASSERT_TRUE(first >= 500 && first < TICKS);
+
+  RbrGame fresh = newGame(1234);
+  game.carry = fresh.carry;
+  rbrGameNew(game, 1234);
+  TEST_ASSERT_TRUE(sameState(game, fresh));
+  uint16_t second = 0;
+  while (second < TICKS && rbrGameStep(game, jumpAt(game, second, 500)))
+    second++;
+  TEST_ASSERT_EQUAL(first, second);
+}
+
+// Different seeds give different terrain
+void test_seeds_differ()
+{
+  RbrGame a = newGame(1);
+  RbrGame b = newGame(2);
+  bool differ = false;
+  for (uint16_t tick = 0; tick < 200 && !differ; ++tick)
+  {
+    rbrTerrainStep(a);
+    rbrTerrainStep(b);
+    differ = a.upper.left != b.upper.left || a.lower.left != b.lower.left;
+  }
+  TEST_ASSERT_TRUE(differ);
+}
+
+// xorshift16 visits every non-zero state once per period of 65535
+void test_rng_period()
+{
+  static uint8_t seen[65536 / 8];
+  Rng rng;
+  rngSeed(rng, 1);
+  uint16_t start = rng.state;
+  for (uint32_t i = 0; i < 65535; ++i)
+  {
+    uint16_t value = rngNext(rng);
+    TEST_ASSERT_NOT_EQUAL(0, value);
+    TEST_ASSERT_FALSE(seen[value >> 3] & (1 << (value & 7)));
+    seen[value >> 3] |= 1 << (value & 7);
+  }
+  TEST_ASSERT_EQUAL(start, rng.state);
+}
+
+void test_rng_zero_seed()
+{
+  Rng rng;
+  rngSeed(rng, 0);
+  TEST_ASSERT_NOT_EQUAL(0, rng.state);
+  rngSeed(rng, 0x10001);
+  TEST_ASSERT_NOT_EQUAL(0, rng.state);
+}
+
+// rngBelow() stays in range and is uniform over one period for the
+// terrain's ranges (chi-square, p = 0.001)
+void test_rng_below_uniform()
+{
+  static const uint8_t ranges[] = {3, 10};
+  // Critical values for 2 and 9 degrees of freedom
+  static const double critical[] = {13.82, 27.88};
+  for (uint8_t r = 0; r < sizeof(ranges); ++r)
+  {
+    uint32_t counts[10] = {0};
+    Rng rng;
+    rngSeed(rng, 1);
+    for (uint32_t i = 0; i < 65535; ++i)
+    {
+      uint8_t value = rngBelow(rng, ranges[r]);
+      TEST_ASSERT_LESS_THAN(ranges[r], value);
+      counts[value]++;
+    }
+    double expected = 65535.0 / ranges[r];
+    double chi = 0;
+    for (uint8_t i = 0; i < ranges[r]; ++i)
+      chi += (counts[i] - expected) * (counts[i] - expected) / expected;
+    TEST_ASSERT_TRUE(chi < critical[r]);
+  }
+}
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_same_seed_same_game);
+  RUN_TEST(test_new_game_restarts);
+  RUN_TEST(test_seeds_differ);
+  RUN_TEST(test_rng_period);
+  RUN_TEST(test_rng_zero_seed);
+  RUN_TEST(test_rng_below_uniform);
+  return UNITY_END();
+}
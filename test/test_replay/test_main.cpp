@@ -0,0 +1,151 @@
+// RBR recordings (include/Replay.h): jumps played back as recorded, runs
+// going round the ring of slots, and aborted runs (pio test -e native)
+
+#include <unity.h>
+#include "Hal.h"
+#include "Replay.h"
+
+static const ReplayHeader sample = {0xDEADBEEF, {150, 3, 1234}, 0};
+
+static void erase()
+{
+  for (uint16_t address = REPLAY_EEPROM_START; address < REPLAY_EEPROM_END; ++address)
+    halEepromWrite(address, 0xFF);
+  replayBegin();
+}
+
+// Jump every `gap` ticks for `jumps` jumps, then end the run
+static void record(uint16_t gap, uint16_t jumps, uint16_t distance)
+{
+  replayRecordBegin(sample);
+  for (uint16_t jump = 0; jump < jumps; ++jump)
+    for (uint16_t tick = 1; tick <= gap; ++tick)
+      replayRecordTick(tick == gap);
+  replayRecordEnd(distance);
+}
+
+// Ticks to the first jump of the last run, 0 without a recording
+static uint16_t firstGap(ReplayHeader &header)
+{
+  if (!replayPlayBegin(header))
+    return 0;
+  uint16_t tick = 1;
+  while (!replayPlayTick())
+    tick++;
+  return tick;
+}
+
+static bool headerAt(uint8_t slot)
+{
+  return halEepromRead(REPLAY_EEPROM_START + slot * REPLAY_SLOT_SIZE) == 'R';
+}
+
+void setUp()
+{
+  erase();
+}
+
+void tearDown()
+{
+}
+
+void test_empty()
+{
+  ReplayHeader header;
+  TEST_ASSERT_FALSE(replayPlayBegin(header));
+}
+
+void test_round_trip()
+{
+  static const uint16_t gaps[] = {1, 5, 127, 128, 300, 2};
+  replayRecordBegin(sample);
+  for (uint8_t i = 0; i < sizeof(gaps) / sizeof(gaps[0]); ++i)
+    for (uint16_t tick = 1; tick <= gaps[i]; ++tick)
+      replayRecordTick(tick == gaps[i]);
+  replayRecordEnd(77);
+
+  // As after a reset
+  replayBegin();
+  ReplayHeader header;
+  TEST_ASSERT_TRUE(replayPlayBegin(header));
+  TEST_ASSERT_EQUAL(sample.seed, header.seed);
+  TEST_ASSERT_EQUAL(sample.carry.speed, header.carry.speed);
+  TEST_ASSERT_EQUAL(sample.carry.stage, header.carry.stage);
+  TEST_ASSERT_EQUAL(sample.carry.highScore, header.carry.highScore);
+  TEST_ASSERT_EQUAL(77, header.distance);
+  for (uint8_t i = 0; i < sizeof(gaps) / sizeof(gaps[0]); ++i)
+    for (uint16_t tick = 1; tick <= gaps[i]; ++tick)
+      TEST_ASSERT_EQUAL(tick == gaps[i], replayPlayTick());
+  TEST_ASSERT_FALSE(replayPlayTick());
+}
+
+// Each run starts in the slot after the previous one and the ring wraps
+void test_runs_rotate()
+{
+  for (uint16_t run = 1; run <= 3 * REPLAY_SLOTS; ++run)
+  {
+    // 17 bytes of header, 10 jumps and the end marker: two slots
+    uint8_t slot = (run - 1) * 2 % REPLAY_SLOTS;
+    record(run % 100 + 1, 10, run);
+    TEST_ASSERT_TRUE(headerAt(slot));
+
+    ReplayHeader header;
+    replayBegin();
+    TEST_ASSERT_EQUAL(run % 100 + 1, firstGap(header));
+    TEST_ASSERT_EQUAL(run, header.distance);
+  }
+}
+
+// A header in the last slot continues at the start of the ring
+void test_wrapped_header()
+{
+  // Three slots, then two each up to the last slot
+  record(3, 20, 1);
+  for (uint8_t slot = 3; slot < REPLAY_SLOTS - 1; slot += 2)
+    record(3, 10, 1);
+  record(9, 10, 2);
+  TEST_ASSERT_TRUE(headerAt(REPLAY_SLOTS - 1));
+  replayBegin();
+  ReplayHeader header;
+  TEST_ASSERT_EQUAL(9, firstGap(header));
+  TEST_ASSERT_EQUAL(2, header.distance);
+}
+
+// A run that is cut short leaves the one before it
+void test_aborted_run()
+{
+  record(7, 10, 5);
+  replayRecordBegin(sample);
+  for (uint16_t tick = 0; tick < 100; ++tick)
+    replayRecordTick(tick % 4 == 0);
+  replayBegin();
+  ReplayHeader header;
+  TEST_ASSERT_EQUAL(7, firstGap(header));
+  TEST_ASSERT_EQUAL(5, header.distance);
+}
+
+// A run longer than the ring is not recorded
+void test_too_long()
+{
+  record(1, REPLAY_EEPROM_END - REPLAY_EEPROM_START, 9);
+  replayBegin();
+  ReplayHeader header;
+  TEST_ASSERT_FALSE(replayPlayBegin(header));
+  // The longest that fits is
+  erase();
+  record(1, REPLAY_EEPROM_END - REPLAY_EEPROM_START - REPLAY_HEADER_SIZE - 1, 9);
+  replayBegin();
+  TEST_ASSERT_EQUAL(1, firstGap(header));
+}
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_empty);
+  RUN_TEST(test_round_trip);
+  RUN_TEST(test_runs_rotate);
+  RUN_TEST(test_wrapped_header);
+  RUN_TEST(test_aborted_run);
+  RUN_TEST(test_too_long);
+  return UNITY_END();
+}
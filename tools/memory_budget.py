@@ -0,0 +1,170 @@
+#!/usr/bin/env python3
+"""Break down the SRAM and flash use of the firmware and check a budget.
+
+Reads the section headers and the symbol table of the linked ELF with
+avr-objdump. SRAM is .data + .bss + .noinit, what is left of it is the
+heap and the stack. Flash is .text + the .data initializers. On AVR the
+string literals that are not in PROGMEM land in .data without a symbol,
+they show up as "(unnamed)". Objects in .text are PROGMEM tables.
+
+Runs after linking as a PlatformIO extra script, with the budgets from
+platformio.ini:
+
+  extra_scripts = post:tools/memory_budget.py
+  custom_sram_budget = 1536
+  custom_flash_budget = 30720
+
+or by hand:
+
+  tools/memory_budget.py .pio/build/nanoatmega328new/firmware.elf --sram 1536
+
+--baseline old.elf prints the change against an earlier build instead: the
+SRAM and flash totals, every section and every symbol whose size differs.
+"""
+
+import argparse
+import re
+import subprocess
+import sys
+
+SRAM_SECTIONS = (".data", ".bss", ".noinit")
+FLASH_SECTIONS = (".text", ".data")
+# "00800100 l     O .bss\t00000080 _ZL5queue"
+SYMBOL = re.compile(r"^([0-9a-fA-F]+) (.{7}) (\S+)\s+([0-9a-fA-F]+) (.*)$")
+# "  1 .data         0000001c  00800100  00000b9c  ..."
+SECTION = re.compile(r"^\s*\d+\s+(\S+)\s+([0-9a-fA-F]+)\s")
+
+
+def objdump(tool, flag, elf):
+    return subprocess.run([tool, flag, "-C", elf], check=True, stdout=subprocess.PIPE,
+                          universal_newlines=True).stdout.splitlines()
+
+
+def read_elf(tool, elf):
+    sections = {}
+    for line in objdump(tool, "-h", elf):
+        match = SECTION.match(line)
+        if match:
+            sections[match.group(1)] = int(match.group(2), 16)
+    symbols = []
+    for line in objdump(tool, "-t", elf):
+        match = SYMBOL.match(line)
+        if not match or " O" not in match.group(2):
+            continue
+        size = int(match.group(4), 16)
+        if size:
+            symbols.append((size, match.group(3), match.group(5).strip()))
+    # Output the patterns do not know would report 0 bytes and pass any
+    # budget
+    if ".text" not in sections or not symbols:
+        raise SystemExit("%s: no .text section or no object symbols in the %s output" % (elf, tool))
+    return sections, symbols
+
+
+def table(title, symbols, section_size, top):
+    print(title)
+    named = sum(size for size, _, _ in symbols)
+    unnamed = section_size - named
+    rows = sorted(symbols, reverse=True)[:top]
+    if unnamed > 0:
+        rows.append((unnamed, "", "(unnamed)"))
+    for size, section, name in rows:
+        print("  %5u  %-8s %s" % (size, section, name))
+
+
+def check(name, used, budget):
+    if not budget:
+        print("%-6s %6u" % (name, used))
+        return True
+    print("%-6s %6u / %u (%u left)" % (name, used, budget, max(budget - used, 0)))
+    if used > budget:
+        print("%s budget exceeded by %u bytes" % (name, used - budget), file=sys.stderr)
+        return False
+    return True
+
+
+def report(elf, sram_budget, flash_budget, top, tool):
+    sections, symbols = read_elf(tool, elf)
+    size = lambda name: sections.get(name, 0)
+    sram = sum(size(s) for s in SRAM_SECTIONS)
+    flash = sum(size(s) for s in FLASH_SECTIONS)
+
+    print("memory budget of %s" % elf)
+    ok = check("SRAM", sram, sram_budget)
+    print("       " + ", ".join("%s %u" % (s, size(s)) for s in SRAM_SECTIONS if size(s)))
+    ok = check("flash", flash, flash_budget) and ok
+    print("       " + ", ".join("%s %u" % (s, size(s)) for s in FLASH_SECTIONS if size(s)))
+
+    ram = [s for s in symbols if s[1] in SRAM_SECTIONS]
+    table("largest SRAM symbols", ram, sram, top)
+    progmem = [s for s in symbols if s[1] == ".text"]
+    table("largest PROGMEM symbols", progmem, 0, top)
+    return ok
+
+
+def compare(elf, baseline, tool):
+    old_sections, old_symbols = read_elf(tool, baseline)
+    new_sections, new_symbols = read_elf(tool, elf)
+
+    print("memory change from %s to %s" % (baseline, elf))
+    for name, members in (("SRAM", SRAM_SECTIONS), ("flash", FLASH_SECTIONS)):
+        old = sum(old_sections.get(s, 0) for s in members)
+        new = sum(new_sections.get(s, 0) for s in members)
+        print("%-6s %6u -> %6u (%+d)" % (name, old, new, new - old))
+    for section in sorted(set(SRAM_SECTIONS + FLASH_SECTIONS)):
+        old = old_sections.get(section, 0)
+        new = new_sections.get(section, 0)
+        if old != new:
+            print("  %-8s %6u -> %6u (%+d)" % (section, old, new, new - old))
+
+    # Symbols by section and name, a symbol that moved shows up twice
+    def sizes(symbols):
+        result = {}
+        for size, section, name in symbols:
+            key = (section, name)
+            result[key] = result.get(key, 0) + size
+        return result
+
+    old = sizes(old_symbols)
+    new = sizes(new_symbols)
+    changes = [(new.get(key, 0) - old.get(key, 0), key) for key in set(old) | set(new)]
+    changes = [change for change in changes if change[0]]
+    print("symbols that changed size")
+    for delta, (section, name) in sorted(changes, key=lambda change: (-abs(change[0]), change[1])):
+        print("  %+6d  %-8s %s" % (delta, section, name))
+
+
+def platformio(env):
+    def budget(option):
+        return int(env.GetProjectOption(option, 0))
+
+    def action(target, source, env):
+        tool = env.subst("$CC").replace("gcc", "objdump")
+        ok = report(str(target[0]), budget("custom_sram_budget"), budget("custom_flash_budget"),
+                    budget("custom_budget_top") or 15, tool)
+        return 0 if ok else 1
+
+    env.AddPostAction("$BUILD_DIR/${PROGNAME}.elf", action)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("elf")
+    parser.add_argument("--sram", type=int, default=0, help="SRAM budget in bytes, 0 for none")
+    parser.add_argument("--flash", type=int, default=0, help="flash budget in bytes, 0 for none")
+    parser.add_argument("-n", "--top", type=int, default=15, help="symbols listed per table")
+    parser.add_argument("--objdump", default="avr-objdump")
+    parser.add_argument("--baseline", metavar="ELF", help="earlier build to compare with")
+    args = parser.parse_args()
+    if args.baseline:
+        compare(args.elf, args.baseline, args.objdump)
+        return 0
+    return 0 if report(args.elf, args.sram, args.flash, args.top, args.objdump) else 1
+
+
+if "Import" in globals():
+    # Loaded by PlatformIO, SCons provides Import()
+    Import("env")  # noqa: F821
+    platformio(env)  # noqa: F821
+elif __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,330 @@
+#!/usr/bin/env python3
+"""Compile a quiz question file into the PROGMEM quiz pack.
+
+Reads the text format described in assets/quiz.txt and writes a C++ file
+with the compressed pack that src/QuizPack.cpp decodes (layout in
+include/QuizPack.h). Every question is four lines: two prompt lines, the
+left and the right answer. Substrings that repeat often are replaced by
+dictionary entries, then characters, dictionary references and the end of
+line marker are Huffman coded with a canonical code. Each question starts
+on a byte boundary so the table of contents can point at it.
+
+  tools/quizc.py assets/quiz.txt -o src/QuizPackData.cpp
+  tools/quizc.py assets/quiz.txt --stats
+"""
+
+import argparse
+import heapq
+import sys
+
+COLS = 20
+ANSWER = COLS - 3
+MAX_BITS = 15
+SYMBOL_END = 0
+SYMBOL_CHAR = 1  # ' ' .. '~' are 1 .. 95
+SYMBOL_DICT = 96
+MAX_DICT = 256 - SYMBOL_DICT
+MIN_WORD, MAX_WORD = 2, 12
+
+
+class QuizError(Exception):
+    pass
+
+
+def parse(path):
+    questions = []
+    block = []
+
+    def finish(number):
+        if not block:
+            return
+        prompts = [text for key, text in block if key == "Q"]
+        fields = {key: text for key, text in block if key != "Q"}
+        where = "%s:%d" % (path, number)
+        if not 1 <= len(prompts) <= 2 or set(fields) != {"L", "R", "A"}:
+            raise QuizError("%s: a question needs one or two Q lines and one L, R and A line" % where)
+        if fields["A"] not in ("L", "R"):
+            raise QuizError("%s: A must be L or R" % where)
+        lines = prompts + [""] * (2 - len(prompts)) + [fields["L"], fields["R"]]
+        for i, line in enumerate(lines):
+            if len(line) > (COLS if i < 2 else ANSWER):
+                raise QuizError("%s: '%s' is too long" % (where, line))
+            if any(not " " <= c <= "~" for c in line):
+                raise QuizError("%s: '%s' is not printable ASCII" % (where, line))
+        questions.append((lines, fields["A"] == "R"))
+        del block[:]
+
+    with open(path) as source:
+        for number, line in enumerate(source, 1):
+            line = line.rstrip("\n")
+            if line.startswith("#"):
+                continue
+            if not line.strip():
+                finish(number)
+                continue
+            key, text = line[0], line[2:]
+            if key not in "QLRA" or line[1:2] not in ("", " "):
+                raise QuizError("%s:%d: unknown line '%s'" % (path, number, line))
+            block.append((key, text if key == "Q" else text.strip()))
+        finish(number + 1)
+    if not questions:
+        raise QuizError("%s: no questions" % path)
+    return questions
+
+
+def tokenize(lines, words):
+    """Greedy longest match of the dictionary words, characters otherwise."""
+    tokens = []
+    at = 0
+    while at < len(lines):
+        for length in range(min(MAX_WORD, len(lines) - at), MIN_WORD - 1, -1):
+            word = words.get(lines[at:at + length])
+            if word is not None:
+                tokens.append(SYMBOL_DICT + word)
+                at += length
+                break
+        else:
+            tokens.append(SYMBOL_CHAR + ord(lines[at]) - 32)
+            at += 1
+    return tokens
+
+
+def build_dictionary(texts, limit):
+    """Pick the substrings that save the most characters, one at a time."""
+    chosen = []
+    texts = list(texts)
+    while len(chosen) < limit:
+        counts = {}
+        for text in texts:
+            for start in range(len(text)):
+                for length in range(MIN_WORD, min(MAX_WORD, len(text) - start) + 1):
+                    word = text[start:start + length]
+                    if "\0" in word:
+                        break
+                    counts[word] = counts.get(word, 0) + 1
+        # Every use saves length - 1 symbols, the entry costs length + 1
+        # bytes of flash and one more symbol in the code
+        best, saving = None, 0
+        for word, count in counts.items():
+            gain = count * (len(word) - 1) - len(word) - 2
+            if gain > saving:
+                best, saving = word, gain
+        if best is None:
+            break
+        chosen.append(best)
+        # Taken text can not be part of another entry
+        texts = [text.replace(best, "\0") for text in texts]
+    return chosen
+
+
+def huffman_lengths(frequencies):
+    """Code length per symbol, limited to MAX_BITS by flattening the counts."""
+    counts = dict(frequencies)
+    while True:
+        heap = [(count, symbol, [symbol]) for symbol, count in counts.items()]
+        heapq.heapify(heap)
+        lengths = dict.fromkeys(counts, 0)
+        if len(heap) == 1:
+            lengths[heap[0][1]] = 1
+            return lengths
+        while len(heap) > 1:
+            a, sa, symbols_a = heapq.heappop(heap)
+            b, sb, symbols_b = heapq.heappop(heap)
+            for symbol in symbols_a + symbols_b:
+                lengths[symbol] += 1
+            heapq.heappush(heap, (a + b, min(sa, sb), symbols_a + symbols_b))
+        if max(lengths.values()) <= MAX_BITS:
+            return lengths
+        counts = {symbol: (count + 1) // 2 for symbol, count in counts.items()}
+
+
+def canonical(lengths):
+    """Symbols in code order and their codes."""
+    order = sorted(lengths, key=lambda symbol: (lengths[symbol], symbol))
+    codes = {}
+    code = 0
+    previous = lengths[order[0]]
+    for symbol in order:
+        code <<= lengths[symbol] - previous
+        previous = lengths[symbol]
+        codes[symbol] = (code, lengths[symbol])
+        code += 1
+    return order, codes
+
+
+class BitWriter:
+    def __init__(self):
+        self.data = bytearray()
+        self.bits = 0
+
+    def write(self, code, length):
+        for i in range(length - 1, -1, -1):
+            if self.bits % 8 == 0:
+                self.data.append(0)
+            if (code >> i) & 1:
+                self.data[-1] |= 0x80 >> (self.bits % 8)
+            self.bits += 1
+
+    def align(self):
+        self.bits = len(self.data) * 8
+
+
+def compile_pack(questions, dictionary_limit):
+    texts = ["\0".join(lines) for lines, _ in questions]
+    words = build_dictionary(texts, min(dictionary_limit, MAX_DICT))
+    index = {word: i for i, word in enumerate(words)}
+
+    streams = []
+    frequencies = {}
+    for lines, _ in questions:
+        stream = []
+        for line in lines:
+            stream += tokenize(line, index) + [SYMBOL_END]
+        streams.append(stream)
+        for symbol in stream:
+            frequencies[symbol] = frequencies.get(symbol, 0) + 1
+    lengths = huffman_lengths(frequencies)
+    order, codes = canonical(lengths)
+
+    writer = BitWriter()
+    toc = []
+    for (lines, right), stream in zip(questions, streams):
+        writer.align()
+        if len(writer.data) > 0xFFFF:
+            raise QuizError("the pack is over 64 KB")
+        toc.append((len(writer.data), right, len(lines[3])))
+        for symbol in stream:
+            writer.write(*codes[symbol])
+    counts = [0] * MAX_BITS
+    for symbol in order:
+        counts[lengths[symbol] - 1] += 1
+    return dict(words=words, toc=toc, counts=counts, symbols=order, bits=bytes(writer.data),
+                longest=max(len(s) for s in streams) * max(lengths.values()))
+
+
+def decode(pack, number):
+    """What the device shows for question `number`, to check the pack."""
+    data = pack["bits"]
+    at = pack["toc"][number][0] * 8
+
+    def bit():
+        nonlocal at
+        value = (data[at >> 3] >> (7 - (at & 7))) & 1
+        at += 1
+        return value
+
+    lines = []
+    line = ""
+    while len(lines) < 4:
+        code = first = index = 0
+        for length in range(1, MAX_BITS + 1):
+            code |= bit()
+            count = pack["counts"][length - 1]
+            if code - first < count:
+                symbol = pack["symbols"][index + code - first]
+                break
+            index += count
+            first = (first + count) << 1
+            code <<= 1
+        else:
+            raise QuizError("bad code in question %d" % number)
+        if symbol == SYMBOL_END:
+            lines.append(line)
+            line = ""
+        elif symbol < SYMBOL_DICT:
+            line += chr(symbol - SYMBOL_CHAR + 32)
+        else:
+            line += pack["words"][symbol - SYMBOL_DICT]
+    return lines
+
+
+def c_bytes(data, indent="    "):
+    rows = []
+    for start in range(0, len(data), 16):
+        rows.append(indent + ", ".join("0x%02X" % b for b in data[start:start + 16]) + ",")
+    return "\n".join(rows)
+
+
+def c_string(text):
+    """A C string literal, NUL-terminated inside the quotes."""
+    return '"' + text.replace("\\", "\\\\").replace('"', '\\"') + '\\0"'
+
+
+def write_source(pack, source_name, path):
+    offsets = []
+    size = 0
+    for word in pack["words"]:
+        offsets.append(size)
+        size += len(word) + 1
+    toc = bytearray()
+    for offset, right, length in pack["toc"]:
+        toc += bytes((offset & 0xFF, offset >> 8, (0x80 if right else 0) | length))
+
+    out = []
+    out.append("// Generated by tools/quizc.py from %s, do not edit" % source_name)
+    out.append("")
+    out.append('#include "QuizPack.h"')
+    out.append('#include "Hal.h"')
+    out.append("")
+    out.append("const uint16_t quizPackQuestions = %d;" % len(pack["toc"]))
+    out.append("")
+    out.append("// Byte offset (little-endian) and correct side << 7 | right answer length")
+    out.append("const uint8_t quizPackToc[] PROGMEM = {\n%s\n};" % c_bytes(toc))
+    out.append("")
+    out.append("// Canonical Huffman code: symbols per code length 1..%d, symbols in code order" % MAX_BITS)
+    out.append("const uint8_t quizPackCodeLengths[QUIZ_PACK_MAX_BITS] PROGMEM = {%s};" %
+               ", ".join(str(count) for count in pack["counts"]))
+    out.append("const uint8_t quizPackSymbols[] PROGMEM = {\n%s\n};" % c_bytes(bytes(pack["symbols"])))
+    out.append("")
+    if pack["words"]:
+        out.append("// Dictionary entries, NUL-terminated")
+        out.append("const char quizPackWords[] PROGMEM =\n%s;" % "\n".join(
+            "    " + c_string(word) for word in pack["words"]))
+        out.append("const uint16_t quizPackWordOffsets[] PROGMEM = {%s};" % ", ".join(
+            str(offset) for offset in offsets))
+    else:
+        out.append("const char quizPackWords[] PROGMEM = \"\";")
+        out.append("const uint16_t quizPackWordOffsets[] PROGMEM = {0};")
+    out.append("")
+    out.append("const uint8_t quizPackBits[] PROGMEM = {\n%s\n};" % c_bytes(pack["bits"]))
+    with open(path, "w") as target:
+        target.write("\n".join(out) + "\n")
+
+
+def stats(questions, pack):
+    plain = sum(sum(len(line) + 1 for line in lines) for lines, _ in questions)
+    tables = len(pack["toc"]) * 3 + MAX_BITS + len(pack["symbols"])
+    words = sum(len(word) + 3 for word in pack["words"])
+    print("%d questions, %d characters" % (len(questions), plain))
+    print("bits %d bytes, table of contents and code %d, dictionary %d entries %d bytes" % (
+        len(pack["bits"]), tables, len(pack["words"]), words))
+    print("total %d bytes of flash (%.0f%% of the text)" % (
+        len(pack["bits"]) + tables + words, 100.0 * (len(pack["bits"]) + tables + words) / plain))
+    print("at most %d bits to decode per question" % pack["longest"])
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("source")
+    parser.add_argument("-o", "--output", help="C++ file to write")
+    parser.add_argument("-d", "--dictionary", type=int, default=64, help="dictionary entries at most")
+    parser.add_argument("--stats", action="store_true", help="print the sizes")
+    args = parser.parse_args()
+    try:
+        questions = parse(args.source)
+        pack = compile_pack(questions, args.dictionary)
+        for number, (lines, _) in enumerate(questions):
+            if decode(pack, number) != lines:
+                raise QuizError("question %d does not decode back" % (number + 1))
+    except (QuizError, OSError) as error:
+        print("quizc: %s" % error, file=sys.stderr)
+        return 1
+    if args.output:
+        write_source(pack, args.source, args.output)
+    if args.stats or not args.output:
+        stats(questions, pack)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,194 @@
+#!/usr/bin/env python3
+"""Decode the frame telemetry of a -DTELEMETRY build.
+
+Reads the binary packets described in include/Telemetry.h from a capture
+file, a serial port (needs pyserial) or stdin ("-"), and prints one line of
+statistics per second of console time. Bytes that are not a valid packet,
+e.g. text from FB_STATS on the same port, are skipped.
+
+  tools/telemetry.py /dev/ttyUSB0 -c frames.csv
+  tools/telemetry.py capture.bin -s seconds.csv
+  .pio/build/native/program -q -s script.txt 2>&1 >/dev/null | tools/telemetry.py -
+
+--compare puts the frame statistics of two captures side by side, e.g. a
+-DLCD_TWI_SYNC build against the default one playing the same game:
+
+  tools/telemetry.py default.bin --compare sync.bin
+"""
+
+import argparse
+import csv
+import os
+import stat
+import struct
+import sys
+
+PACKET = struct.Struct("<2sBBHH4HHHHBB")
+SYNC = b"\xa5\x5a"
+TICK_US = 4
+SECTIONS = ("input", "terrain", "render", "flush")
+FIELDS = ("seq", "state", "ms", "frame_us") + tuple(s + "_us" for s in SECTIONS) + (
+    "lcd_bytes", "free", "free_min", "late")
+
+
+def open_source(path, baud):
+    if path == "-":
+        return sys.stdin.buffer
+    if stat.S_ISCHR(os.stat(path).st_mode):
+        import serial
+        return serial.Serial(path, baud)
+    return open(path, "rb")
+
+
+def packets(source):
+    """Yields one dict per packet with a valid checksum."""
+    buffer = b""
+    lost = 0
+    while True:
+        chunk = source.read(PACKET.size if hasattr(source, "in_waiting") else 4096)
+        if not chunk:
+            break
+        buffer += chunk
+        while len(buffer) >= PACKET.size:
+            start = buffer.find(SYNC)
+            if start < 0:
+                buffer = buffer[-1:]
+                break
+            buffer = buffer[start:]
+            if len(buffer) < PACKET.size:
+                break
+            raw = buffer[:PACKET.size]
+            if sum(raw[2:-1]) & 0xFF != raw[-1]:
+                # Not a packet after all, look for the next sync
+                buffer = buffer[1:]
+                lost += 1
+                continue
+            buffer = buffer[PACKET.size:]
+            _, seq, state, ms, frame, i, t, r, f, lcd, free, free_min, late, _ = PACKET.unpack(raw)
+            yield dict(seq=seq, state=state, ms=ms, frame_us=frame * TICK_US,
+                       input_us=i * TICK_US, terrain_us=t * TICK_US, render_us=r * TICK_US,
+                       flush_us=f * TICK_US, lcd_bytes=lcd, free=free, free_min=free_min, late=late)
+    if lost:
+        print("%d bytes skipped" % lost, file=sys.stderr)
+
+
+class Second:
+    def __init__(self, second):
+        self.second = second
+        self.frames = []
+
+    def row(self):
+        frames = self.frames
+        times = [p["frame_us"] for p in frames]
+        row = dict(second=self.second, frames=len(frames), frame_min_us=min(times),
+                   frame_avg_us=sum(times) // len(times), frame_max_us=max(times),
+                   overruns=sum(1 for p in frames if p["late"]), late_ticks=sum(p["late"] for p in frames),
+                   lcd_bytes=sum(p["lcd_bytes"] for p in frames), free_min=min(p["free_min"] for p in frames),
+                   lost=self.lost(), states=" ".join(sorted({str(p["state"]) for p in frames})))
+        for s in SECTIONS:
+            row[s + "_avg_us"] = sum(p[s + "_us"] for p in frames) // len(frames)
+        return row
+
+    def lost(self):
+        # Packets missing from the sequence numbers
+        missing = 0
+        for a, b in zip(self.frames, self.frames[1:]):
+            missing += (b["seq"] - a["seq"] - 1) & 0xFF
+        return missing
+
+
+SECOND_FIELDS = ("second", "frames", "frame_min_us", "frame_avg_us", "frame_max_us") + tuple(
+    s + "_avg_us" for s in SECTIONS) + ("overruns", "late_ticks", "lcd_bytes", "free_min", "lost", "states")
+
+
+def print_second(row):
+    print("%5ds %4d frames  frame %5d/%5d/%5d us  in %4d  ter %4d  ren %4d  fl %5d  late %d/%d  lcd %5d B  "
+          "free %4d  states %s" % (
+              row["second"], row["frames"], row["frame_min_us"], row["frame_avg_us"], row["frame_max_us"],
+              row["input_avg_us"], row["terrain_avg_us"], row["render_avg_us"], row["flush_avg_us"],
+              row["overruns"], row["late_ticks"], row["lcd_bytes"], row["free_min"], row["states"]))
+    sys.stdout.flush()
+
+
+def percentile(values, fraction):
+    values = sorted(values)
+    return values[min(len(values) - 1, int(len(values) * fraction))]
+
+
+def summary(frames):
+    """Statistics over all frames of a capture."""
+    times = [p["frame_us"] for p in frames]
+    row = dict(frames=len(frames), frame_min_us=min(times), frame_avg_us=sum(times) // len(times),
+               frame_median_us=percentile(times, 0.5), frame_p95_us=percentile(times, 0.95),
+               frame_max_us=max(times), overruns=sum(1 for p in frames if p["late"]),
+               late_ticks=sum(p["late"] for p in frames),
+               lcd_bytes_avg=sum(p["lcd_bytes"] for p in frames) // len(frames))
+    for s in SECTIONS:
+        row[s + "_avg_us"] = sum(p[s + "_us"] for p in frames) // len(frames)
+    return row
+
+
+def compare(first, second, baud):
+    rows = []
+    for path in (first, second):
+        frames = list(packets(open_source(path, baud)))
+        if not frames:
+            raise SystemExit("%s: no telemetry packets" % path)
+        rows.append(summary(frames))
+    print("%-16s %12s %12s %8s" % ("", os.path.basename(first)[:12], os.path.basename(second)[:12], "change"))
+    for key in ("frames", "frame_min_us", "frame_avg_us", "frame_median_us", "frame_p95_us", "frame_max_us") + tuple(
+            s + "_avg_us" for s in SECTIONS) + ("overruns", "late_ticks", "lcd_bytes_avg"):
+        a, b = rows[0][key], rows[1][key]
+        change = "%+.0f%%" % (100.0 * (b - a) / a) if a else ""
+        print("%-16s %12d %12d %8s" % (key, a, b, change))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("source", help="capture file, serial port or - for stdin")
+    parser.add_argument("-b", "--baud", type=int, default=1000000)
+    parser.add_argument("-c", "--frames-csv", help="write every packet to this CSV file")
+    parser.add_argument("-s", "--seconds-csv", help="write the per-second statistics to this CSV file")
+    parser.add_argument("--compare", metavar="CAPTURE", help="compare the frame statistics with a second capture")
+    args = parser.parse_args()
+    if args.compare:
+        compare(args.source, args.compare, args.baud)
+        return
+
+    frames_csv = seconds_csv = None
+    if args.frames_csv:
+        frames_csv = csv.DictWriter(open(args.frames_csv, "w", newline=""), fieldnames=("time_ms",) + FIELDS)
+        frames_csv.writeheader()
+    if args.seconds_csv:
+        seconds_csv = csv.DictWriter(open(args.seconds_csv, "w", newline=""), fieldnames=SECOND_FIELDS)
+        seconds_csv.writeheader()
+
+    def done(second):
+        row = second.row()
+        print_second(row)
+        if seconds_csv:
+            seconds_csv.writerow(row)
+
+    # The ms field wraps every 65.5 s
+    base = 0
+    last_ms = None
+    second = None
+    for packet in packets(open_source(args.source, args.baud)):
+        if last_ms is not None and packet["ms"] < last_ms:
+            base += 0x10000
+        last_ms = packet["ms"]
+        time_ms = base + packet["ms"]
+        if frames_csv:
+            frames_csv.writerow(dict(packet, time_ms=time_ms))
+        if second and second.second != time_ms // 1000:
+            done(second)
+            second = None
+        if not second:
+            second = Second(time_ms // 1000)
+        second.frames.append(packet)
+    if second:
+        done(second)
+
+
+if __name__ == "__main__":
+    main()